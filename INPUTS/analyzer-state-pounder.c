@@ -0,0 +1,43 @@
+// Hammer the creation of exploded nodes and program states in the static
+// analyzer: the paths of each function below split at every branch, and each
+// path binds values to many variables and memory regions, so hardly any state
+// is shared between nodes. Run with
+//   -analyze -analyzer-checker=core,debug.Stats -analyzer-stats
+// to see the number of nodes, the live states and the memory of the graph.
+
+int cond(int);
+void use(int *);
+
+#define BRANCH(i)                                                              \
+  if (cond(i)) {                                                               \
+    a[(i) % 16] = (i);                                                         \
+    s.f[(i) % 8] += a[((i) + 1) % 16];                                         \
+  } else {                                                                     \
+    b[(i) % 16] = a[(i) % 16] + (i);                                           \
+  }
+#define BRANCH_4(i) BRANCH(i) BRANCH(i + 1) BRANCH(i + 2) BRANCH(i + 3)
+#define BRANCH_16(i) BRANCH_4(i) BRANCH_4(i + 4) \
+                     BRANCH_4(i + 8) BRANCH_4(i + 12)
+
+struct S {
+  int f[8];
+};
+
+#define FUNCTION(name)                                                         \
+  int name(void) {                                                             \
+    int a[16] = { 0 }, b[16] = { 0 };                                          \
+    struct S s = { { 0 } };                                                    \
+    BRANCH_16(0)                                                               \
+    use(a);                                                                    \
+    use(b);                                                                    \
+    return s.f[0];                                                             \
+  }
+
+FUNCTION(f0)
+FUNCTION(f1)
+FUNCTION(f2)
+FUNCTION(f3)
+FUNCTION(f4)
+FUNCTION(f5)
+FUNCTION(f6)
+FUNCTION(f7)
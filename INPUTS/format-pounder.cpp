@@ -0,0 +1,23 @@
+// Hammer clang-format's search for the best line breaks: each statement below
+// is a long, deeply nested expression with many possible break points, so the
+// search visits a large number of states, each with a deep stack of
+// parenthesis levels. Run clang-format on this file and time it.
+
+int f(int, int, int);
+int g(...);
+
+int deeplyNested(int a, int b, int c) {
+  return f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(a, b + 0 * c, c - 0), b + 1 * c, c - 1), b + 2 * c, c - 2), b + 3 * c, c - 3), b + 4 * c, c - 4), b + 5 * c, c - 5), b + 6 * c, c - 6), b + 7 * c, c - 7), b + 8 * c, c - 8), b + 9 * c, c - 9), b + 10 * c, c - 10), b + 11 * c, c - 11), b + 12 * c, c - 12), b + 13 * c, c - 13), b + 14 * c, c - 14), b + 15 * c, c - 15), b + 16 * c, c - 16), b + 17 * c, c - 17), b + 18 * c, c - 18), b + 19 * c, c - 19), b + 20 * c, c - 20), b + 21 * c, c - 21), b + 22 * c, c - 22), b + 23 * c, c - 23);
+}
+
+int manyArguments(int a, int b, int c) {
+  int v0 = g(f(a + 0, b * 0, f(c, a, 0)), f(a + 1, b * 0, f(c, a, 1)), f(a + 2, b * 0, f(c, a, 2)), f(a + 3, b * 0, f(c, a, 3)), f(a + 4, b * 0, f(c, a, 4)), f(a + 5, b * 0, f(c, a, 5)), f(a + 6, b * 0, f(c, a, 6)), f(a + 7, b * 0, f(c, a, 7)), f(a + 8, b * 0, f(c, a, 8)), f(a + 9, b * 0, f(c, a, 9)), f(a + 10, b * 0, f(c, a, 10)), f(a + 11, b * 0, f(c, a, 11)));
+  int v1 = g(f(a + 0, b * 1, f(c, a, 1)), f(a + 1, b * 1, f(c, a, 2)), f(a + 2, b * 1, f(c, a, 3)), f(a + 3, b * 1, f(c, a, 4)), f(a + 4, b * 1, f(c, a, 5)), f(a + 5, b * 1, f(c, a, 6)), f(a + 6, b * 1, f(c, a, 7)), f(a + 7, b * 1, f(c, a, 8)), f(a + 8, b * 1, f(c, a, 9)), f(a + 9, b * 1, f(c, a, 10)), f(a + 10, b * 1, f(c, a, 11)), f(a + 11, b * 1, f(c, a, 12)));
+  int v2 = g(f(a + 0, b * 2, f(c, a, 2)), f(a + 1, b * 2, f(c, a, 3)), f(a + 2, b * 2, f(c, a, 4)), f(a + 3, b * 2, f(c, a, 5)), f(a + 4, b * 2, f(c, a, 6)), f(a + 5, b * 2, f(c, a, 7)), f(a + 6, b * 2, f(c, a, 8)), f(a + 7, b * 2, f(c, a, 9)), f(a + 8, b * 2, f(c, a, 10)), f(a + 9, b * 2, f(c, a, 11)), f(a + 10, b * 2, f(c, a, 12)), f(a + 11, b * 2, f(c, a, 13)));
+  int v3 = g(f(a + 0, b * 3, f(c, a, 3)), f(a + 1, b * 3, f(c, a, 4)), f(a + 2, b * 3, f(c, a, 5)), f(a + 3, b * 3, f(c, a, 6)), f(a + 4, b * 3, f(c, a, 7)), f(a + 5, b * 3, f(c, a, 8)), f(a + 6, b * 3, f(c, a, 9)), f(a + 7, b * 3, f(c, a, 10)), f(a + 8, b * 3, f(c, a, 11)), f(a + 9, b * 3, f(c, a, 12)), f(a + 10, b * 3, f(c, a, 13)), f(a + 11, b * 3, f(c, a, 14)));
+  int v4 = g(f(a + 0, b * 4, f(c, a, 4)), f(a + 1, b * 4, f(c, a, 5)), f(a + 2, b * 4, f(c, a, 6)), f(a + 3, b * 4, f(c, a, 7)), f(a + 4, b * 4, f(c, a, 8)), f(a + 5, b * 4, f(c, a, 9)), f(a + 6, b * 4, f(c, a, 10)), f(a + 7, b * 4, f(c, a, 11)), f(a + 8, b * 4, f(c, a, 12)), f(a + 9, b * 4, f(c, a, 13)), f(a + 10, b * 4, f(c, a, 14)), f(a + 11, b * 4, f(c, a, 15)));
+  int v5 = g(f(a + 0, b * 5, f(c, a, 5)), f(a + 1, b * 5, f(c, a, 6)), f(a + 2, b * 5, f(c, a, 7)), f(a + 3, b * 5, f(c, a, 8)), f(a + 4, b * 5, f(c, a, 9)), f(a + 5, b * 5, f(c, a, 10)), f(a + 6, b * 5, f(c, a, 11)), f(a + 7, b * 5, f(c, a, 12)), f(a + 8, b * 5, f(c, a, 13)), f(a + 9, b * 5, f(c, a, 14)), f(a + 10, b * 5, f(c, a, 15)), f(a + 11, b * 5, f(c, a, 16)));
+  int v6 = g(f(a + 0, b * 6, f(c, a, 6)), f(a + 1, b * 6, f(c, a, 7)), f(a + 2, b * 6, f(c, a, 8)), f(a + 3, b * 6, f(c, a, 9)), f(a + 4, b * 6, f(c, a, 10)), f(a + 5, b * 6, f(c, a, 11)), f(a + 6, b * 6, f(c, a, 12)), f(a + 7, b * 6, f(c, a, 13)), f(a + 8, b * 6, f(c, a, 14)), f(a + 9, b * 6, f(c, a, 15)), f(a + 10, b * 6, f(c, a, 16)), f(a + 11, b * 6, f(c, a, 17)));
+  int v7 = g(f(a + 0, b * 7, f(c, a, 7)), f(a + 1, b * 7, f(c, a, 8)), f(a + 2, b * 7, f(c, a, 9)), f(a + 3, b * 7, f(c, a, 10)), f(a + 4, b * 7, f(c, a, 11)), f(a + 5, b * 7, f(c, a, 12)), f(a + 6, b * 7, f(c, a, 13)), f(a + 7, b * 7, f(c, a, 14)), f(a + 8, b * 7, f(c, a, 15)), f(a + 9, b * 7, f(c, a, 16)), f(a + 10, b * 7, f(c, a, 17)), f(a + 11, b * 7, f(c, a, 18)));
+  return v0 + v1 + v2 + v3 + v4 + v5 + v6 + v7;
+}
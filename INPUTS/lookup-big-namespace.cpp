@@ -0,0 +1,38 @@
+// Hammer the name lookup tables of declaration contexts with a namespace of
+// 65536 members and a class of 32768 members, like those of generated code,
+// followed by lookups into them. Run with -fsyntax-only -Xclang -print-stats
+// to see the size of the lookup tables.
+
+#define DECLS_2(x)     DECL(x##0) DECL(x##1)
+#define DECLS_8(x)     DECLS_2(x##0) DECLS_2(x##1) DECLS_2(x##2) DECLS_2(x##3)
+#define DECLS_64(x)    DECLS_8(x##0) DECLS_8(x##1) DECLS_8(x##2) DECLS_8(x##3) \
+                       DECLS_8(x##4) DECLS_8(x##5) DECLS_8(x##6) DECLS_8(x##7)
+#define DECLS_512(x)   DECLS_64(x##0) DECLS_64(x##1) DECLS_64(x##2) \
+                       DECLS_64(x##3) DECLS_64(x##4) DECLS_64(x##5) \
+                       DECLS_64(x##6) DECLS_64(x##7)
+#define DECLS_4096(x)  DECLS_512(x##0) DECLS_512(x##1) DECLS_512(x##2) \
+                       DECLS_512(x##3) DECLS_512(x##4) DECLS_512(x##5) \
+                       DECLS_512(x##6) DECLS_512(x##7)
+#define DECLS_32768(x) DECLS_4096(x##0) DECLS_4096(x##1) DECLS_4096(x##2) \
+                       DECLS_4096(x##3) DECLS_4096(x##4) DECLS_4096(x##5) \
+                       DECLS_4096(x##6) DECLS_4096(x##7)
+
+namespace generated {
+#define DECL(x) int f##x(int); struct S##x;
+DECLS_32768(_)
+#undef DECL
+}
+
+struct Generated {
+#define DECL(x) int m##x;
+DECLS_32768(_)
+#undef DECL
+};
+
+int use(Generated &G) {
+  int Sum = 0;
+#define DECL(x) Sum += generated::f##x(G.m##x);
+  DECLS_4096(_0)
+#undef DECL
+  return Sum;
+}
@@ -0,0 +1,59 @@
+// Hammer the instantiation of function template definitions at the end of the
+// translation unit: every function used below is only instantiated once the
+// whole file has been parsed, and each instantiation requires further ones.
+// Run with -fsyntax-only -Xclang -print-stats to see the number of pending
+// implicit instantiations that were processed.
+
+template <int N> struct Int { static const int value = N; };
+
+template <typename T, int N> struct Node {
+  T Value;
+  Node<T, N - 1> Next;
+
+  T sum() const { return Value + Next.sum(); }
+  T product() const { return Value * Next.product(); }
+  void fill(T V) { Value = V; Next.fill(V + 1); }
+  template <typename F> void apply(F f) { f(Value); Next.apply(f); }
+};
+
+template <typename T> struct Node<T, 0> {
+  T sum() const { return T(); }
+  T product() const { return T(1); }
+  void fill(T) {}
+  template <typename F> void apply(F) {}
+};
+
+template <typename T> struct Accumulate {
+  T Total;
+  Accumulate() : Total() {}
+  void operator()(T V) { Total += V; }
+};
+
+template <typename T, int N> T run() {
+  Node<T, N> List;
+  List.fill(T(1));
+  Accumulate<T> Acc;
+  List.apply(Acc);
+  return List.sum() + List.product() + Acc.Total;
+}
+
+#define RUN_4(T, N)  run<T, N>() + run<T, N + 1>() + run<T, N + 2>() + \
+                     run<T, N + 3>()
+#define RUN_16(T, N) RUN_4(T, N) + RUN_4(T, N + 4) + RUN_4(T, N + 8) + \
+                     RUN_4(T, N + 12)
+#define RUN_64(T, N) RUN_16(T, N) + RUN_16(T, N + 16) + RUN_16(T, N + 32) + \
+                     RUN_16(T, N + 48)
+
+struct Big {
+  long long V;
+  Big() : V(0) {}
+  Big(int V) : V(V) {}
+  Big operator+(Big O) const { return Big(V + O.V); }
+  Big operator*(Big O) const { return Big(V * O.V); }
+  Big &operator+=(Big O) { V += O.V; return *this; }
+};
+
+int runInts() { return RUN_64(int, 1); }
+long runLongs() { return RUN_64(long, 1); }
+double runDoubles() { return RUN_64(double, 1); }
+Big runBigs() { return RUN_64(Big, 1); }
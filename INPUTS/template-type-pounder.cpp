@@ -0,0 +1,42 @@
+// Hammer type uniquing in ASTContext: the recursive instantiations below
+// create hundreds of thousands of distinct template specialization, function,
+// pointer and reference types, each of which is looked up in the folding sets
+// of ASTContext several times. Run with -fsyntax-only -Xclang -print-stats to
+// see the number of types created.
+
+template <typename... Ts> struct List {};
+
+template <typename T, int N> struct Wrap {
+  typedef Wrap<T *, N - 1> Next;
+  typedef typename Next::type type;
+  typedef void (*Fn)(T, const T &, T *, typename Next::Fn);
+};
+
+template <typename T> struct Wrap<T, 0> {
+  typedef T type;
+  typedef void (*Fn)(T);
+};
+
+template <typename L, int N> struct Grow;
+
+template <typename... Ts, int N> struct Grow<List<Ts...>, N> {
+  typedef List<Ts..., typename Wrap<List<Ts...>, 16>::type,
+               typename Wrap<void (*)(Ts...), 16>::Fn> Bigger;
+  typedef typename Grow<Bigger, N - 1>::type type;
+};
+
+template <typename... Ts> struct Grow<List<Ts...>, 0> {
+  typedef List<Ts...> type;
+};
+
+#define GROW(T) Grow<List<T>, 48>::type
+typedef GROW(char) T0;
+typedef GROW(short) T1;
+typedef GROW(int) T2;
+typedef GROW(long) T3;
+typedef GROW(float) T4;
+typedef GROW(double) T5;
+typedef GROW(unsigned char) T6;
+typedef GROW(unsigned short) T7;
+typedef GROW(unsigned) T8;
+typedef GROW(unsigned long) T9;
@@ -22,6 +22,7 @@
 #include "clang-c/CXErrorCode.h"
 #include "clang-c/CXString.h"
 #include "clang-c/BuildSystem.h"
+#include "clang-c/CXCompilationDatabase.h"
 
 /**
  * \brief The version constants for the libclang API.
@@ -32,7 +33,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 27
+#define CINDEX_VERSION_MINOR 31
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -4624,6 +4625,51 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
 CINDEX_LINKAGE
 void clang_sortCodeCompletionResults(CXCompletionResult *Results,
                                      unsigned NumResults);
+
+/**
+ * \brief Filter the code-completion results by the text typed so far.
+ *
+ * A result matches if the characters of \p Filter appear, in order and
+ * ignoring case, in its typed text. The matches are ranked by how well they
+ * match, e.g., prefix and word-start matches ("gNV" for "getNextValue") rank
+ * higher, then by priority, then alphabetically; they can be retrieved in that
+ * order with \c clang_codeCompleteGetFilteredResult().
+ *
+ * When \p Filter extends the filter of the previous call on the same
+ * results, for example because the user typed another character, only the
+ * previous matches are examined again, so the code-completion results can be
+ * kept and refiltered on each keystroke rather than recomputed.
+ *
+ * \param Results The code-completion results to filter. The order of
+ * \c Results->Results must not be changed while filtering them.
+ *
+ * \param Filter The text typed so far. An empty or NULL filter matches all
+ * results.
+ *
+ * \returns The number of results that match \p Filter.
+ */
+CINDEX_LINKAGE
+unsigned clang_codeCompleteFilterResults(CXCodeCompleteResults *Results,
+                                         const char *Filter);
+
+/**
+ * \brief Retrieve a code-completion result matching the last filter passed to
+ * \c clang_codeCompleteFilterResults(), by rank.
+ *
+ * Results are only ranked as far as they are requested, so retrieving the top
+ * few matches does not require sorting all of them.
+ *
+ * \param Results The code-completion results that were filtered.
+ *
+ * \param Rank The zero-based rank of the match, which must be less than the
+ * number of matches.
+ *
+ * \returns The index of the match in \c Results->Results, or
+ * \c Results->NumResults if \p Rank is out of range.
+ */
+CINDEX_LINKAGE
+unsigned clang_codeCompleteGetFilteredResult(CXCodeCompleteResults *Results,
+                                             unsigned Rank);
   
 /**
  * \brief Free the given set of code-completion results.
@@ -5316,6 +5362,19 @@ clang_index_getClientEntity(const CXIdxEntityInfo *);
 CINDEX_LINKAGE void
 clang_index_setClientEntity(const CXIdxEntityInfo *, CXIdxClientEntity);
 
+/**
+ * \brief Retrieve the ID of the USR of an entity.
+ *
+ * USRs are interned per index action: every entity with the same USR gets
+ * the same non-zero ID in all the translation units indexed with that
+ * action, and its \c USR string stays valid until the action is disposed.
+ * Use \c clang_IndexAction_getUSR() to map an ID back to its USR.
+ *
+ * \returns the ID of the USR, or 0 if the entity has no USR.
+ */
+CINDEX_LINKAGE unsigned
+clang_index_getEntityUSRID(const CXIdxEntityInfo *);
+
 /**
  * \brief An indexing action/session, to be applied to one or multiple
  * translation units.
@@ -5338,6 +5397,39 @@ CINDEX_LINKAGE CXIndexAction clang_IndexAction_create(CXIndex CIdx);
  */
 CINDEX_LINKAGE void clang_IndexAction_dispose(CXIndexAction);
 
+/**
+ * \brief Restrict function body parsing of the main file to a line range.
+ *
+ * When a focus range is set, the bodies of functions in the main file of
+ * translations units indexed with \p action are only parsed if they overlap
+ * the lines [\p start_line, \p end_line]; all other bodies are skipped and
+ * reported with \c CXIdxDeclFlag_Skipped, while their declarations are still
+ * indexed. The extent of a skipped function still covers its body, so the
+ * body can be tokenized or the focus range moved and the file re-indexed.
+ * Bodies in system headers are always skipped, bodies in other headers follow
+ * \c CXIndexOpt_SkipParsedBodiesInSession.
+ *
+ * This only affects C++ translation units.
+ *
+ * \param start_line The first line of the focus range (1-based). Passing 0
+ * clears the focus range.
+ *
+ * \param end_line The last line of the focus range, inclusive.
+ */
+CINDEX_LINKAGE void clang_IndexAction_setFocusRange(CXIndexAction action,
+                                                    unsigned start_line,
+                                                    unsigned end_line);
+
+/**
+ * \brief Retrieve the USR with the given ID, as returned by
+ * \c clang_index_getEntityUSRID() for an entity indexed with \p action.
+ *
+ * \returns the USR, which stays valid until \p action is disposed, or NULL if
+ * \p usr_id is not a valid ID.
+ */
+CINDEX_LINKAGE const char *clang_IndexAction_getUSR(CXIndexAction action,
+                                                    unsigned usr_id);
+
 typedef enum {
   /**
    * \brief Used to indicate that no special indexing options are needed.
@@ -5438,6 +5530,65 @@ CINDEX_LINKAGE int clang_indexTranslationUnit(CXIndexAction,
                                               unsigned index_options,
                                               CXTranslationUnit);
 
+/**
+ * \brief Callback reporting the progress of #clang_indexCompilationDatabase.
+ *
+ * It is invoked once for every compile command after it has been indexed,
+ * never concurrently.
+ *
+ * \param client_data the client data given to the indexing function.
+ *
+ * \param source_filename the source file that was indexed.
+ *
+ * \param num_indexed the number of compile commands indexed so far.
+ *
+ * \param num_total the total number of compile commands to index.
+ *
+ * \param result the value #clang_indexSourceFile returned for this file.
+ */
+typedef void (*CXIndexProgressCallback)(CXClientData client_data,
+                                        const char *source_filename,
+                                        unsigned num_indexed,
+                                        unsigned num_total,
+                                        int result);
+
+/**
+ * \brief Index every compile command of the given compilation database via
+ * callbacks implemented through #IndexerCallbacks.
+ *
+ * The translation units are indexed concurrently on \p num_threads worker
+ * threads, all using the same \c CXIndexAction, so that state kept by the
+ * indexing session is shared between them; e.g. with
+ * \c CXIndexOpt_SkipParsedBodiesInSession a function body in a header is
+ * parsed and reported by only one of the translation units including it.
+ *
+ * The compile commands are run in their respective directories without
+ * changing the working directory of the process.
+ *
+ * Callbacks for a single translation unit are always invoked on the same
+ * thread, but callbacks for different translation units may be invoked
+ * concurrently, so they must be thread-safe.
+ *
+ * \param num_threads the number of worker threads to use. If zero, the number
+ * of hardware threads is used.
+ *
+ * \param progress optional callback invoked after each compile command has
+ * been indexed.
+ *
+ * The rest of the parameters are the same as #clang_indexSourceFile.
+ *
+ * \returns 0 if every compile command was indexed successfully, otherwise
+ * a non-zero \c CXErrorCode.
+ */
+CINDEX_LINKAGE int clang_indexCompilationDatabase(CXIndexAction,
+                                          CXClientData client_data,
+                                          IndexerCallbacks *index_callbacks,
+                                          unsigned index_callbacks_size,
+                                          unsigned index_options,
+                                          CXCompilationDatabase database,
+                                          unsigned num_threads,
+                                          CXIndexProgressCallback progress);
+
 /**
  * \brief Retrieve the CXIdxFile, file, line, column, and offset represented by
  * the given CXIdxLoc.
@@ -53,6 +53,13 @@ public:
     return ASTNodeKind(KindToKindId<T>::Id);
   }
 
+  /// \{
+  /// \brief Construct an identifier for the dynamic type of the node.
+  static ASTNodeKind getFromNode(const Decl &D);
+  static ASTNodeKind getFromNode(const Stmt &S);
+  static ASTNodeKind getFromNode(const Type &T);
+  /// \}
+
   /// \brief Returns \c true if \c this and \c Other represent the same kind.
   bool isSame(ASTNodeKind Other) const;
 
@@ -191,6 +198,12 @@ public:
   /// method returns NULL.
   const void *getMemoizationData() const;
 
+  /// \brief Returns the kind the node was created as.
+  ///
+  /// For \c Decl, \c Stmt and \c Type nodes this can be a base of the node's
+  /// dynamic kind, see \c ASTNodeKind::getFromNode().
+  ASTNodeKind getNodeKind() const { return NodeKind; }
+
   /// \brief Prints the node to the given output stream.
   void print(llvm::raw_ostream &OS, const PrintingPolicy &PP) const;
 
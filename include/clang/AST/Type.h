@@ -1073,14 +1073,23 @@ class ExtQuals : public ExtQualsTypeCommonBase, public llvm::FoldingSetNode {
   /// node;  always contains extended qualifiers.
   Qualifiers Quals;
 
+  /// \brief The hash of the profile of this node in ASTContext's folding set,
+  /// or 0 if it has not been computed yet. On 64-bit hosts, this takes the
+  /// padding after \c Quals.
+  mutable unsigned CachedProfileHash;
+
+  template <typename T> friend struct CachedHashTypeFoldingSetTrait;
+
   ExtQuals *this_() { return this; }
 
 public:
   ExtQuals(const Type *baseType, QualType canon, Qualifiers quals)
     : ExtQualsTypeCommonBase(baseType,
                              canon.isNull() ? QualType(this_(), 0) : canon),
-      Quals(quals)
+      Quals(quals), CachedProfileHash(0)
   {
+    static_assert(sizeof(void *) != 8 || sizeof(ExtQuals) == 4 * sizeof(void *),
+                  "CachedProfileHash does not fit in the padding of ExtQuals");
     assert(Quals.hasNonFastQualifiers()
            && "ExtQuals created with no fast qualifiers");
     assert(!Quals.hasFastQualifiers()
@@ -1350,6 +1359,15 @@ protected:
   };
 
 private:
+  /// \brief The hash of the profile of this type in the FoldingSet that
+  /// uniques it, or 0 if it has not been computed yet. On 64-bit hosts, this
+  /// takes the padding after the bitfields above.
+  mutable unsigned CachedProfileHash;
+
+  template <typename T> friend struct CachedHashTypeFoldingSetTrait;
+  template <typename T, typename Ctx>
+  friend struct CachedHashTypeContextualFoldingSetTrait;
+
   /// \brief Set whether this type comes from an AST file.
   void setFromAST(bool V = true) const {
     TypeBits.FromAST = V;
@@ -1374,6 +1392,9 @@ protected:
     TypeBits.CachedLocalOrUnnamed = false;
     TypeBits.CachedLinkage = NoLinkage;
     TypeBits.FromAST = false;
+    CachedProfileHash = 0;
+    static_assert(sizeof(void *) != 8 || sizeof(Type) == 3 * sizeof(void *),
+                  "CachedProfileHash does not fit in the padding of Type");
   }
   friend class ASTContext;
 
@@ -5242,6 +5263,110 @@ inline const ArrayType *Type::castAsArrayTypeUnsafe() const {
   return cast<ArrayType>(getUnqualifiedDesugaredType());
 }
 
+/// \brief FoldingSet traits for the types that ASTContext uniques, which
+/// remember the hash of the profile of each type.
+///
+/// Growing a folding set rehashes all of its nodes, and looking up a profile
+/// compares it with every node in its bucket; for types whose profile
+/// involves parameter types or template arguments, profiling a node is much
+/// more expensive than comparing two hashes.
+template <typename T>
+struct CachedHashTypeFoldingSetTrait : llvm::DefaultFoldingSetTrait<T> {
+  static bool Equals(T &X, const llvm::FoldingSetNodeID &ID, unsigned IDHash,
+                     llvm::FoldingSetNodeID &TempID) {
+    if (X.CachedProfileHash && X.CachedProfileHash != IDHash)
+      return false;
+    X.Profile(TempID);
+    if (TempID == ID) {
+      X.CachedProfileHash = IDHash;
+      return true;
+    }
+    X.CachedProfileHash = TempID.ComputeHash();
+    return false;
+  }
+
+  static unsigned ComputeHash(T &X, llvm::FoldingSetNodeID &TempID) {
+    if (!X.CachedProfileHash) {
+      X.Profile(TempID);
+      X.CachedProfileHash = TempID.ComputeHash();
+    }
+    return X.CachedProfileHash;
+  }
+};
+
+/// \brief The ContextualFoldingSet counterpart of
+/// \c CachedHashTypeFoldingSetTrait.
+template <typename T, typename Ctx>
+struct CachedHashTypeContextualFoldingSetTrait
+    : llvm::DefaultContextualFoldingSetTrait<T, Ctx> {
+  static bool Equals(T &X, const llvm::FoldingSetNodeID &ID, unsigned IDHash,
+                     llvm::FoldingSetNodeID &TempID, Ctx Context) {
+    if (X.CachedProfileHash && X.CachedProfileHash != IDHash)
+      return false;
+    X.Profile(TempID, Context);
+    if (TempID == ID) {
+      X.CachedProfileHash = IDHash;
+      return true;
+    }
+    X.CachedProfileHash = TempID.ComputeHash();
+    return false;
+  }
+
+  static unsigned ComputeHash(T &X, llvm::FoldingSetNodeID &TempID,
+                              Ctx Context) {
+    if (!X.CachedProfileHash) {
+      X.Profile(TempID, Context);
+      X.CachedProfileHash = TempID.ComputeHash();
+    }
+    return X.CachedProfileHash;
+  }
+};
+
 }  // end namespace clang
 
+namespace llvm {
+#define CACHED_HASH_TYPE(Class)                                                \
+  template <>                                                                  \
+  struct FoldingSetTrait<clang::Class>                                         \
+      : clang::CachedHashTypeFoldingSetTrait<clang::Class> {};
+#define CACHED_HASH_CONTEXTUAL_TYPE(Class)                                     \
+  template <>                                                                  \
+  struct ContextualFoldingSetTrait<clang::Class, clang::ASTContext &>          \
+      : clang::CachedHashTypeContextualFoldingSetTrait<clang::Class,           \
+                                                       clang::ASTContext &> {};
+CACHED_HASH_TYPE(ExtQuals)
+CACHED_HASH_TYPE(ComplexType)
+CACHED_HASH_TYPE(PointerType)
+CACHED_HASH_TYPE(AdjustedType)
+CACHED_HASH_TYPE(BlockPointerType)
+CACHED_HASH_TYPE(LValueReferenceType)
+CACHED_HASH_TYPE(RValueReferenceType)
+CACHED_HASH_TYPE(MemberPointerType)
+CACHED_HASH_TYPE(ConstantArrayType)
+CACHED_HASH_TYPE(IncompleteArrayType)
+CACHED_HASH_TYPE(DependentSizedArrayType)
+CACHED_HASH_TYPE(DependentSizedExtVectorType)
+CACHED_HASH_TYPE(VectorType)
+CACHED_HASH_TYPE(FunctionNoProtoType)
+CACHED_HASH_CONTEXTUAL_TYPE(FunctionProtoType)
+CACHED_HASH_TYPE(DependentTypeOfExprType)
+CACHED_HASH_TYPE(DependentDecltypeType)
+CACHED_HASH_TYPE(TemplateTypeParmType)
+CACHED_HASH_TYPE(SubstTemplateTypeParmType)
+CACHED_HASH_TYPE(SubstTemplateTypeParmPackType)
+CACHED_HASH_CONTEXTUAL_TYPE(TemplateSpecializationType)
+CACHED_HASH_TYPE(ParenType)
+CACHED_HASH_TYPE(ElaboratedType)
+CACHED_HASH_TYPE(DependentNameType)
+CACHED_HASH_CONTEXTUAL_TYPE(DependentTemplateSpecializationType)
+CACHED_HASH_TYPE(PackExpansionType)
+CACHED_HASH_TYPE(ObjCObjectTypeImpl)
+CACHED_HASH_TYPE(ObjCObjectPointerType)
+CACHED_HASH_TYPE(AutoType)
+CACHED_HASH_TYPE(AtomicType)
+CACHED_HASH_TYPE(AttributedType)
+#undef CACHED_HASH_CONTEXTUAL_TYPE
+#undef CACHED_HASH_TYPE
+}  // end namespace llvm
+
 #endif
@@ -42,11 +42,44 @@
 #define LLVM_CLANG_AST_MATCHERS_AST_MATCH_FINDER_H
 
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Timer.h"
 
 namespace clang {
 
 namespace ast_matchers {
 
+/// \brief What a \c MatchFinder records about the matchers of one callback
+/// when profiling is enabled.
+struct MatcherProfile {
+  MatcherProfile()
+      : Invocations(0), Matches(0), CacheHits(0), CacheMisses(0) {}
+
+  /// \brief The number of nodes the top-level matchers were run on.
+  unsigned Invocations;
+
+  /// \brief The number of nodes the top-level matchers matched.
+  unsigned Matches;
+
+  /// \brief The number of memoized results of nested traversals (like
+  /// \c hasDescendant() or \c hasAncestor()) that were reused or computed.
+  /// @{
+  unsigned CacheHits;
+  unsigned CacheMisses;
+  /// @}
+
+  /// \brief The time spent in the matchers, including nested traversals but
+  /// not the callback.
+  llvm::TimeRecord Time;
+
+  /// \brief The part of \c Time spent in nested traversals.
+  llvm::TimeRecord TraversalTime;
+};
+
+/// \brief Prints \p Profiles as a table, the most expensive matchers first.
+void printMatcherProfiles(const llvm::StringMap<MatcherProfile> &Profiles,
+                          raw_ostream &OS);
+
 /// \brief A class to allow finding matches over the Clang AST.
 ///
 /// After creation, you can add multiple matchers to the MatchFinder via
@@ -102,6 +135,27 @@ public:
     ///
     /// Optionally override to do per translation unit tasks.
     virtual void onEndOfTranslationUnit() {}
+
+    /// \brief An ID used to group profiling records.
+    ///
+    /// By default, matchers are identified by the order in which they were
+    /// added to the \c MatchFinder.
+    virtual StringRef getID() const { return StringRef(); }
+  };
+
+  struct MatchFinderOptions {
+    MatchFinderOptions() : ProfileRecords(nullptr) {}
+
+    /// \brief If not null, enables profiling of the matchers and receives
+    /// the per matcher records, keyed by \c MatchCallback::getID().
+    ///
+    /// Matchers whose callback has no ID are keyed by "matcher #<N>", where N
+    /// is the position in which they were added. Records are added to, so
+    /// several runs can be accumulated.
+    ///
+    /// Profiling measures every matcher invocation, which slows matching
+    /// down considerably.
+    llvm::StringMap<MatcherProfile> *ProfileRecords;
   };
 
   /// \brief Called when parsing is finished. Intended for testing only.
@@ -111,7 +165,7 @@ public:
     virtual void run() = 0;
   };
 
-  MatchFinder();
+  MatchFinder(MatchFinderOptions Options = MatchFinderOptions());
   ~MatchFinder();
 
   /// \brief Adds a matcher to execute when running over the AST.
@@ -179,6 +233,8 @@ private:
   std::vector<std::pair<internal::DynTypedMatcher, MatchCallback *> >
     MatcherCallbackPairs;
 
+  const MatchFinderOptions Options;
+
   /// \brief Called when parsing is done.
   ParsingDoneTestCallback *ParsingDone;
 };
@@ -159,6 +159,16 @@ private:
 
 class ASTMatchFinder;
 
+/// \brief Returns \p Derived if it is derived from \p Base, and \p Base
+/// otherwise.
+///
+/// Used to combine two kinds that a matched node is known to have.
+inline ast_type_traits::ASTNodeKind
+getMoreDerivedKind(ast_type_traits::ASTNodeKind Base,
+                   ast_type_traits::ASTNodeKind Derived) {
+  return Base.isBaseOf(Derived) ? Derived : Base;
+}
+
 /// \brief Generic interface for matchers on an AST node of type T.
 ///
 /// Implement this if your matcher may need to inspect the children or
@@ -178,6 +188,14 @@ public:
   virtual bool matches(const T &Node,
                        ASTMatchFinder *Finder,
                        BoundNodesTreeBuilder *Builder) const = 0;
+
+  /// \brief Returns a kind that all nodes matched by this matcher have.
+  ///
+  /// Matchers that only match nodes of a type derived from \c T override
+  /// this, which allows \c MatchFinder to skip them for other nodes.
+  virtual ast_type_traits::ASTNodeKind getRestrictKind() const {
+    return ast_type_traits::ASTNodeKind::getFromNodeKind<T>();
+  }
 };
 
 /// \brief Interface for matchers that only evaluate properties on a single
@@ -253,6 +271,11 @@ public:
     return reinterpret_cast<uint64_t>(Implementation.get());
   }
 
+  /// \brief Returns a kind that all nodes matched by this matcher have.
+  ast_type_traits::ASTNodeKind getRestrictKind() const {
+    return Implementation->getRestrictKind();
+  }
+
   /// \brief Allows the conversion of a \c Matcher<Type> to a \c
   /// Matcher<QualType>.
   ///
@@ -289,6 +312,11 @@ private:
       return From.matches(Node, Finder, Builder);
     }
 
+    ast_type_traits::ASTNodeKind getRestrictKind() const override {
+      return getMoreDerivedKind(MatcherInterface<T>::getRestrictKind(),
+                                From.getRestrictKind());
+    }
+
   private:
     const Matcher<Base> From;
   };
@@ -346,6 +374,15 @@ public:
     return Storage->getSupportedKind();
   }
 
+  /// \brief Returns a kind that all nodes matched by this matcher have.
+  ///
+  /// This is the supported kind, or a kind derived from it if the matcher is
+  /// known to only match more specific nodes, e.g. \c recordDecl().
+  ast_type_traits::ASTNodeKind getRestrictKind() const {
+    ast_type_traits::ASTNodeKind RestrictKind = Storage->getRestrictKind();
+    return getMoreDerivedKind(getSupportedKind(), RestrictKind);
+  }
+
   /// \brief Returns \c true if the passed \c DynTypedMatcher can be converted
   ///   to a \c Matcher<T>.
   ///
@@ -385,6 +422,8 @@ private:
 
     virtual llvm::Optional<DynTypedMatcher> tryBind(StringRef ID) const = 0;
 
+    virtual ast_type_traits::ASTNodeKind getRestrictKind() const = 0;
+
     ast_type_traits::ASTNodeKind getSupportedKind() const {
       return SupportedKind;
     }
@@ -425,6 +464,10 @@ public:
     return DynTypedMatcher(BindableMatcher<T>(InnerMatcher).bind(ID));
   }
 
+  ast_type_traits::ASTNodeKind getRestrictKind() const override {
+    return InnerMatcher.getRestrictKind();
+  }
+
 private:
   const Matcher<T> InnerMatcher;
   const bool AllowBind;
@@ -1010,6 +1053,10 @@ public:
     return Result;
   }
 
+  ast_type_traits::ASTNodeKind getRestrictKind() const override {
+    return InnerMatcher.getRestrictKind();
+  }
+
 private:
   const std::string ID;
   const Matcher<T> InnerMatcher;
@@ -1109,6 +1156,8 @@ public:
                 InnerMatchers);
   }
 
+  ast_type_traits::ASTNodeKind getRestrictKind() const override;
+
 private:
   const VariadicOperatorFunction Func;
   const std::vector<DynTypedMatcher> InnerMatchers;
@@ -1293,6 +1342,19 @@ bool AnyOfVariadicOperator(const ast_type_traits::DynTypedNode DynNode,
                            BoundNodesTreeBuilder *Builder,
                            ArrayRef<DynTypedMatcher> InnerMatchers);
 
+template <typename T>
+ast_type_traits::ASTNodeKind
+VariadicOperatorMatcherInterface<T>::getRestrictKind() const {
+  ast_type_traits::ASTNodeKind Kind = MatcherInterface<T>::getRestrictKind();
+  // A node only matches allOf() if it matches all inner matchers, so it has
+  // the kinds of all of them.
+  if (Func == AllOfVariadicOperator) {
+    for (const DynTypedMatcher &InnerMatcher : InnerMatchers)
+      Kind = getMoreDerivedKind(Kind, InnerMatcher.getRestrictKind());
+  }
+  return Kind;
+}
+
 template <typename T>
 inline Matcher<T> DynTypedMatcher::unconditionalConvertTo() const {
   return Matcher<T>(new VariadicOperatorMatcherInterface<T>(
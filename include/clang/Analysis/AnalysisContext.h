@@ -397,6 +397,11 @@ class AnalysisDeclContextManager {
 
   ContextMap Contexts;
   LocationContextManager LocContexts;
+
+  /// When each context was last requested, used to pick the contexts to keep
+  /// when clearing.
+  llvm::DenseMap<const Decl*, unsigned> LastUse;
+  unsigned UseCounter;
   CFG::BuildOptions cfgBuildOptions;
   
   /// Flag to indicate whether or not bodies should be synthesized
@@ -416,6 +421,9 @@ public:
 
   AnalysisDeclContext *getContext(const Decl *D);
 
+  /// Returns true if a context for \p D was created and not discarded since.
+  bool hasContext(const Decl *D) const { return Contexts.count(D) != 0; }
+
   bool getUseUnoptimizedCFG() const {
     return !cfgBuildOptions.PruneTriviallyFalseEdges;
   }
@@ -451,8 +459,11 @@ public:
     return LocContexts.getStackFrame(getContext(D), Parent, S, Blk, Idx);
   }
 
-  /// Discard all previously created AnalysisDeclContexts.
-  void clear();
+  /// Discard previously created AnalysisDeclContexts.
+  ///
+  /// \param NumToKeep The number of most recently used contexts to keep, so
+  /// that their CFGs and analyses can be reused. Discards all contexts if 0.
+  void clear(unsigned NumToKeep = 0);
 
 private:
   friend class AnalysisDeclContext;
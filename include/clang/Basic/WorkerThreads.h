@@ -0,0 +1,41 @@
+//===--- WorkerThreads.h - Run Work on a Set of Threads ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines a helper that runs a worker function on several threads.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_WORKERTHREADS_H
+#define LLVM_CLANG_BASIC_WORKERTHREADS_H
+
+#include <functional>
+
+namespace clang {
+
+/// \brief Calls \p Worker once on each of up to \p NumThreads threads and
+/// waits for all calls to return.
+///
+/// The calling thread is one of the workers. \p Worker is expected to take
+/// items from a queue shared by all calls until it is empty.
+///
+/// \param NumThreads The number of threads to use, or 0 to use one per
+/// hardware thread.
+///
+/// \param NumItems The number of work items; no more threads than items are
+/// used.
+///
+/// When threading is disabled, \p Worker is called once on the calling
+/// thread.
+void runOnWorkerThreads(const std::function<void()> &Worker,
+                        unsigned NumThreads, unsigned NumItems);
+
+} // end namespace clang
+
+#endif
@@ -153,6 +153,18 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// CC1ToolFunc - Entry point of the -cc1 tool, taking the full argument
+  /// vector (including the executable and "-cc1").
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+
+  /// The -cc1 entry point used to run frontend jobs inside the driver process.
+  /// If null, every job is executed as a separate process.
+  ///
+  /// It must return rather than exit or crash the driver: a crash is reported
+  /// as a negative result and a fatal error as the status the frontend would
+  /// have exited with.
+  CC1ToolFunc CC1Main;
+
 private:
   /// Name to use when invoking gcc/g++.
   std::string CCCGenericGCCName;
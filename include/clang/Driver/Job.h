@@ -32,6 +32,7 @@ class Job {
 public:
   enum JobClass {
     CommandClass,
+    CC1CommandClass,
     FallbackCommandClass,
     JobListClass
   };
@@ -72,6 +73,10 @@ class Command : public Job {
   /// argument, which will be the executable).
   llvm::opt::ArgStringList Arguments;
 
+protected:
+  Command(JobClass _Kind, const Action &_Source, const Tool &_Creator,
+          const char *_Executable, const llvm::opt::ArgStringList &_Arguments);
+
 public:
   Command(const Action &_Source, const Tool &_Creator, const char *_Executable,
           const llvm::opt::ArgStringList &_Arguments);
@@ -94,10 +99,32 @@ public:
 
   static bool classof(const Job *J) {
     return J->getKind() == CommandClass ||
+           J->getKind() == CC1CommandClass ||
            J->getKind() == FallbackCommandClass;
   }
 };
 
+/// CC1Command - A -cc1 command which may be run inside the driver process,
+/// through Driver::CC1Main, instead of spawning a new clang process.
+class CC1Command : public Command {
+  /// InProcess - Whether this command should be executed in-process.
+  bool InProcess;
+
+public:
+  CC1Command(const Action &Source_, const Tool &Creator_,
+             const char *Executable_, const ArgStringList &Arguments_);
+
+  int Execute(const StringRef **Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+
+  bool isInProcess() const { return InProcess; }
+  void setInProcess(bool Value) { InProcess = Value; }
+
+  static bool classof(const Job *J) {
+    return J->getKind() == CC1CommandClass;
+  }
+};
+
 /// Like Command, but with a fallback which is executed in case
 /// the primary command crashes.
 class FallbackCommand : public Command {
@@ -17,7 +17,10 @@
 
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Tooling/Refactoring.h"
+#include "llvm/Support/Mutex.h"
+#include <map>
 #include <system_error>
+#include <vector>
 
 namespace clang {
 
@@ -467,6 +470,53 @@ std::error_code parseConfiguration(StringRef Text, FormatStyle *Style);
 /// \brief Gets configuration in a YAML string.
 std::string configurationAsText(const FormatStyle &Style);
 
+/// \brief Remembers how unwrapped lines were broken, so that formatting a
+/// line that did not change does not search for its best formatting again.
+///
+/// Lines are identified by their tokens, the indent and context they are
+/// formatted in, and the style. The cache can be saved to a file and loaded
+/// again by later runs, e.g. by editor integrations that format on every save.
+///
+/// The cache can be shared by files formatted concurrently.
+class FormattingCache {
+public:
+  struct Entry {
+    /// \brief The penalty of the formatted line.
+    unsigned Penalty;
+
+    /// \brief For each token after the first one, whether it starts a new
+    /// line.
+    std::vector<bool> NewLines;
+
+    /// \brief Whether the entry was used since the cache was loaded.
+    bool Used;
+  };
+
+  /// \brief Adds the entries stored in \p FileName. Returns \c false if the
+  /// file cannot be read or is not a formatting cache.
+  bool load(StringRef FileName);
+
+  /// \brief Writes at most \p MaxEntries entries to \p FileName, preferring
+  /// the entries used since the cache was loaded. Returns \c false on error.
+  bool save(StringRef FileName, unsigned MaxEntries = 100000) const;
+
+  /// \brief Returns the entry of the line with the given \p Key, or null.
+  ///
+  /// Entries are not modified once inserted, so the result stays valid while
+  /// other lines are added.
+  const Entry *lookup(uint64_t Key);
+
+  /// \brief Records how the line with the given \p Key was formatted, unless
+  /// it is already known.
+  void insert(uint64_t Key, unsigned Penalty, const std::vector<bool> &NewLines);
+
+  unsigned size() const;
+
+private:
+  mutable llvm::sys::Mutex Lock;
+  std::map<uint64_t, Entry> Entries;
+};
+
 /// \brief Reformats the given \p Ranges in the token stream coming out of
 /// \c Lex.
 ///
@@ -474,18 +524,23 @@ std::string configurationAsText(const FormatStyle &Style);
 /// everything that might influence its formatting or might be influenced by its
 /// formatting.
 ///
+/// If \p Cache is not null, lines found in it are formatted without searching
+/// for their best formatting, and the other lines are added to it.
+///
 /// Returns the \c Replacements necessary to make all \p Ranges comply with
 /// \p Style.
 tooling::Replacements reformat(const FormatStyle &Style, Lexer &Lex,
                                SourceManager &SourceMgr,
-                               std::vector<CharSourceRange> Ranges);
+                               std::vector<CharSourceRange> Ranges,
+                               FormattingCache *Cache = nullptr);
 
 /// \brief Reformats the given \p Ranges in \p Code.
 ///
 /// Otherwise identical to the reformat() function consuming a \c Lexer.
 tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                std::vector<tooling::Range> Ranges,
-                               StringRef FileName = "<stdin>");
+                               StringRef FileName = "<stdin>",
+                               FormattingCache *Cache = nullptr);
 
 /// \brief Returns the \c LangOpts that the formatter expects you to set.
 ///
@@ -521,6 +576,11 @@ extern const char *StyleOptionHelpDescription;
 FormatStyle getStyle(StringRef StyleName, StringRef FileName,
                      StringRef FallbackStyle);
 
+/// \brief Same as above, writing errors to \p Errs instead of
+/// \c llvm::errs().
+FormatStyle getStyle(StringRef StyleName, StringRef FileName,
+                     StringRef FallbackStyle, raw_ostream &Errs);
+
 } // end namespace format
 } // end namespace clang
 
@@ -233,14 +233,23 @@ public:
     /// buffers it is zero.
     time_t ModTime;
 
-    /// Memory buffers have MD5 instead of modification time.  We don't
-    /// compute MD5 for on-disk files because we hope that modification time is
-    /// enough to tell if the file was changed.
+    /// Memory buffers have MD5 instead of modification time.  The preamble
+    /// doesn't compute MD5 for on-disk files because we hope that
+    /// modification time is enough to tell if the file was changed. The files
+    /// whose contents the last parse loaded have both, as an edit that keeps
+    /// the size and is saved within the same second as the parse doesn't
+    /// change either; the MD5 is zero otherwise.
     llvm::MD5::MD5Result MD5;
 
     static PreambleFileHash createForFile(off_t Size, time_t ModTime);
     static PreambleFileHash
     createForMemoryBuffer(const llvm::MemoryBuffer *Buffer);
+    static PreambleFileHash
+    createForFileContents(off_t Size, time_t ModTime,
+                          const llvm::MemoryBuffer *Buffer);
+
+    /// \brief Whether the MD5 of the contents is known.
+    bool hasMD5() const;
 
     friend bool operator==(const PreambleFileHash &LHS,
                            const PreambleFileHash &RHS);
@@ -269,6 +278,14 @@ private:
   /// the preamble must be thrown away.
   llvm::StringMap<PreambleFileHash> FilesInPreamble;
 
+  /// \brief Keeps track of the files that were used by the last parse, if it
+  /// produced no errors, including the main file and the preamble files.
+  ///
+  /// If none of the files have changed when reparsing, the AST is kept. The
+  /// contents of the files loaded by the parse, rather than the preamble, are
+  /// compared as well.
+  llvm::StringMap<PreambleFileHash> FilesInLastParse;
+
   /// \brief When non-NULL, this is the buffer used to store the contents of
   /// the main file when it has been padded for use with the precompiled
   /// preamble.
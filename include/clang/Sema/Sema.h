@@ -1687,7 +1687,7 @@ public:
   void computeNRVO(Stmt *Body, sema::FunctionScopeInfo *Scope);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body, bool IsInstantiation);
-  Decl *ActOnSkippedFunctionBody(Decl *Decl);
+  Decl *ActOnSkippedFunctionBody(Decl *Decl, SourceRange BodyRange);
   void ActOnFinishInlineMethodDef(CXXMethodDecl *D);
 
   /// ActOnFinishDelayedAttribute - Invoked when we have finished parsing an
@@ -6556,6 +6556,23 @@ public:
   /// but have not yet been performed.
   std::deque<PendingImplicitInstantiation> PendingInstantiations;
 
+  /// \brief The implicit instantiations that could not be performed at the
+  /// end of a prefix built with -fpch-instantiate-templates because their
+  /// templates were not defined yet. They are left pending, for the
+  /// translation units using the prefix to perform.
+  SmallVector<PendingImplicitInstantiation, 4> PendingInstantiationsAfterPrefix;
+
+  typedef std::deque<PendingImplicitInstantiation> PendingInstantiationQueue;
+
+  /// \brief Empty queues of pending instantiations, kept for reuse by
+  /// \c SavePendingInstantiationQueueRAII.
+  SmallVector<std::unique_ptr<PendingInstantiationQueue>, 4>
+      SparePendingInstantiationQueues;
+
+  /// \brief The number of entries processed from the queues of pending
+  /// implicit instantiations.
+  unsigned NumPendingInstantiationsPerformed;
+
   /// \brief The queue of implicit template instantiations that are required
   /// and must be performed within the current local scope.
   ///
@@ -6570,24 +6587,78 @@ public:
   typedef llvm::DenseMap<Decl *, OMPDeclareSimdDecl *> PendingOMPInstMap;
   PendingOMPInstMap PendingOMP;
 
-  class SavePendingLocalImplicitInstantiationsRAII {
+  /// \brief Sets a queue of pending implicit instantiations aside until
+  /// \c restore() is called or this object is destroyed, so that the
+  /// instantiations queued in the meantime are performed first.
+  ///
+  /// An empty queue is not set aside at all, and the storage of the queues
+  /// that are is recycled through \c SparePendingInstantiationQueues: one
+  /// queue per instantiated definition is a measurable cost at the end of
+  /// template-heavy translation units.
+  class SavePendingInstantiationQueueRAII {
   public:
-    SavePendingLocalImplicitInstantiationsRAII(Sema &S): S(S) {
-      SavedPendingLocalImplicitInstantiations.swap(
-          S.PendingLocalImplicitInstantiations);
+    SavePendingInstantiationQueueRAII(Sema &S, PendingInstantiationQueue &Queue,
+                                      bool Enabled)
+        : S(S), Queue(Queue), Enabled(Enabled), Restored(false) {
+      if (!Enabled || Queue.empty())
+        return;
+      if (S.SparePendingInstantiationQueues.empty()) {
+        Saved.reset(new PendingInstantiationQueue);
+      } else {
+        Saved = std::move(S.SparePendingInstantiationQueues.back());
+        S.SparePendingInstantiationQueues.pop_back();
+      }
+      Saved->swap(Queue);
     }
 
-    ~SavePendingLocalImplicitInstantiationsRAII() {
-      assert(S.PendingLocalImplicitInstantiations.empty() &&
-             "there shouldn't be any pending local implicit instantiations");
-      SavedPendingLocalImplicitInstantiations.swap(
-          S.PendingLocalImplicitInstantiations);
+    ~SavePendingInstantiationQueueRAII() { restore(); }
+
+    /// \brief Puts the queue that was set aside back. The instantiations
+    /// queued in the meantime must have been performed.
+    void restore() {
+      if (Restored)
+        return;
+      Restored = true;
+      assert((!Enabled || Queue.empty()) &&
+             "there shouldn't be any pending implicit instantiations");
+      if (!Saved)
+        return;
+      Saved->swap(Queue);
+      // Never hand out leftover instantiations with the recycled storage.
+      Saved->clear();
+      S.SparePendingInstantiationQueues.push_back(std::move(Saved));
     }
 
   private:
+    SavePendingInstantiationQueueRAII(
+        const SavePendingInstantiationQueueRAII &) LLVM_DELETED_FUNCTION;
+    void operator=(
+        const SavePendingInstantiationQueueRAII &) LLVM_DELETED_FUNCTION;
+
     Sema &S;
-    std::deque<PendingImplicitInstantiation>
-    SavedPendingLocalImplicitInstantiations;
+    PendingInstantiationQueue &Queue;
+    bool Enabled;
+    bool Restored;
+    std::unique_ptr<PendingInstantiationQueue> Saved;
+  };
+
+  class SavePendingLocalImplicitInstantiationsRAII
+      : public SavePendingInstantiationQueueRAII {
+  public:
+    SavePendingLocalImplicitInstantiationsRAII(Sema &S)
+        : SavePendingInstantiationQueueRAII(
+              S, S.PendingLocalImplicitInstantiations, /*Enabled=*/true) {}
+  };
+
+  /// \brief Sets the pending implicit instantiations aside while a
+  /// definition is instantiated, if \p Recursive, so that the instantiations
+  /// it requires are performed within its instantiation context.
+  class SavePendingInstantiationsRAII
+      : public SavePendingInstantiationQueueRAII {
+  public:
+    SavePendingInstantiationsRAII(Sema &S, bool Recursive)
+        : SavePendingInstantiationQueueRAII(S, S.PendingInstantiations,
+                                            Recursive) {}
   };
 
   void PerformPendingInstantiations(bool LocalOnly = false);
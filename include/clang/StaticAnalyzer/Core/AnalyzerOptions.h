@@ -239,12 +239,24 @@ private:
   /// \sa getGraphTrimInterval
   Optional<unsigned> GraphTrimInterval;
 
+  /// \sa getCFGCacheSize
+  Optional<unsigned> CFGCacheSize;
+
   /// \sa getMaxTimesInlineLarge
   Optional<unsigned> MaxTimesInlineLarge;
 
   /// \sa getMaxNodesPerTopLevelFunction
   Optional<unsigned> MaxNodesPerTopLevelFunction;
 
+  /// \sa getMaxGraphMemory
+  Optional<unsigned> MaxGraphMemory;
+
+  /// \sa getNumAnalysisShards
+  Optional<unsigned> NumAnalysisShards;
+
+  /// \sa getAnalysisShardIndex
+  Optional<unsigned> AnalysisShardIndex;
+
 public:
   /// Interprets an option's string value as a boolean.
   ///
@@ -258,6 +270,11 @@ public:
   /// Interprets an option's string value as an integer value.
   int getOptionAsInteger(StringRef Name, int DefaultVal);
 
+  /// Query an option's string value.
+  ///
+  /// If an option value is not provided, returns the given \p DefaultVal.
+  StringRef getOptionAsString(StringRef Name, StringRef DefaultVal);
+
   /// \brief Retrieves and sets the UserMode. This is a high-level option,
   /// which is used to set other low-level options. It is not accessible
   /// outside of AnalyzerOptions.
@@ -402,6 +419,13 @@ public:
   /// node reclamation, set the option to "0".
   unsigned getGraphTrimInterval();
 
+  /// Returns the number of functions whose CFGs, and the analyses computed
+  /// on them, are kept between the analyses of top level functions.
+  ///
+  /// This is controlled by the 'cfg-cache-size' config option. To rebuild
+  /// the CFGs for each top level function, set the option to "0".
+  unsigned getCFGCacheSize();
+
   /// Returns the maximum times a large function could be inlined.
   ///
   /// This is controlled by the 'max-times-inline-large' config option.
@@ -414,6 +438,35 @@ public:
   /// This is controlled by the 'max-nodes' config option.
   unsigned getMaxNodesPerTopLevelFunction();
 
+  /// Returns the memory budget, in megabytes, of the exploded graph of a top
+  /// level function. Past half of the budget, nodes only needed for precise
+  /// path diagnostics are reclaimed; past the budget, only small functions
+  /// are inlined. 0 means no limit.
+  ///
+  /// This is a soft limit: the memory in use is only checked when nodes are
+  /// reclaimed (see 'graph-trim-interval'), and the analysis goes on past the
+  /// budget, only more coarsely; 'max-nodes' still bounds the graph.
+  ///
+  /// This is controlled by the 'max-graph-memory' config option.
+  unsigned getMaxGraphMemory();
+
+  /// Returns the number of shards the analysis of a translation unit is split
+  /// into. Each shard is run by a separate analyzer invocation, so that the
+  /// top level functions of a large translation unit can be analyzed by
+  /// several processes in parallel.
+  ///
+  /// This is controlled by the 'shard-count' config option. The default, 1,
+  /// analyzes the whole translation unit.
+  unsigned getNumAnalysisShards();
+
+  /// Returns the index, in [0, getNumAnalysisShards()), of the shard that
+  /// should be analyzed. Only the top level functions assigned to this shard
+  /// are analyzed path-sensitively; AST-based checks run in shard 0 only.
+  /// Other indices are rejected when the options are parsed.
+  ///
+  /// This is controlled by the 'shard-index' config option.
+  unsigned getAnalysisShardIndex();
+
 public:
   AnalyzerOptions() :
     AnalysisStoreOpt(RegionStoreModel),
@@ -54,8 +54,11 @@ public:
 
   ~AnalysisManager();
   
+  /// Discard the AnalysisDeclContexts of the previously analyzed functions,
+  /// except for the most recently used ones, whose CFGs and analyses are
+  /// likely to be needed again for inlining.
   void ClearContexts() {
-    AnaCtxMgr.clear();
+    AnaCtxMgr.clear(options.getCFGCacheSize());
   }
   
   AnalysisDeclContextManager& getAnalysisDeclContextManager() {
@@ -287,6 +287,17 @@ protected:
   /// Counter to determine when to reclaim nodes.
   unsigned ReclaimCounter;
 
+  /// The number of bytes the nodes and states of the graph may use, or 0 if
+  /// the memory is not limited.
+  size_t MemoryBudget;
+
+  /// Set once half of the memory budget is used. Nodes that are only kept
+  /// for precise path diagnostics are then reclaimed as well.
+  bool AggressiveReclamation;
+
+  /// Set once the whole memory budget is used.
+  bool OverMemoryBudget;
+
 public:
 
   /// \brief Retrieve the node associated with a (Location,State) pair,
@@ -386,6 +397,16 @@ public:
   /// was called.
   void reclaimRecentlyAllocatedNodes();
 
+  /// Set a soft limit of \p Bytes on the memory used by the nodes and states
+  /// of the graph; past it, the engine explores more coarsely.
+  ///
+  /// The memory in use is only checked whenever nodes are reclaimed, so this
+  /// has no effect unless node reclamation is enabled.
+  void setMemoryBudget(size_t Bytes) { MemoryBudget = Bytes; }
+
+  /// Returns true if the graph has used up its memory budget.
+  bool isOverMemoryBudget() const { return OverMemoryBudget; }
+
   /// \brief Returns true if nodes for the given expression kind are always
   ///        kept around.
   static bool isInterestingLValueExpr(const Expr *Ex);
@@ -496,6 +496,9 @@ public:
 
   llvm::BumpPtrAllocator& getAllocator() { return Alloc; }
 
+  /// Returns the number of distinct states that are currently alive.
+  unsigned getNumLiveStates() const { return StateSet.size(); }
+
   MemRegionManager& getRegionManager() {
     return svalBuilder->getRegionManager();
   }
@@ -22,8 +22,9 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/StringRef.h"
-#include <set>
+#include <algorithm>
 #include <string>
+#include <vector>
 
 namespace clang {
 
@@ -132,9 +133,82 @@ bool operator<(const Replacement &LHS, const Replacement &RHS);
 /// \brief Equal-to operator between two Replacements.
 bool operator==(const Replacement &LHS, const Replacement &RHS);
 
-/// \brief A set of Replacements.
-/// FIXME: Change to a vector and deduplicate in the RefactoringTool.
-typedef std::set<Replacement> Replacements;
+/// \brief A set of Replacements, ordered by \c operator< and without
+/// duplicates.
+///
+/// The replacements are kept in a flat vector rather than in a tree, so
+/// refactorings that produce many replacements do not pay for a node
+/// allocation per replacement. Inserted replacements are appended, and only
+/// sorted and deduplicated, together, when the set is next read.
+///
+/// Inserting invalidates all iterators. Reading a set that has pending
+/// insertions modifies it, so it must not be done from several threads at
+/// once.
+class Replacements {
+public:
+  typedef Replacement value_type;
+  typedef std::vector<Replacement>::const_iterator const_iterator;
+  typedef const_iterator iterator;
+  typedef std::vector<Replacement>::size_type size_type;
+
+  Replacements() : NumSorted(0) {}
+
+  /// \brief Adds \p Replace, unless the set already contains it.
+  void insert(const Replacement &Replace) {
+    Replaces.push_back(Replace);
+    compactIfNeeded();
+  }
+
+  /// \brief Adds all replacements in [\p Begin, \p End).
+  template <typename InputIterator>
+  void insert(InputIterator Begin, InputIterator End) {
+    Replaces.insert(Replaces.end(), Begin, End);
+    compactIfNeeded();
+  }
+
+  void clear() {
+    Replaces.clear();
+    NumSorted = 0;
+  }
+
+  bool empty() const { return Replaces.empty(); }
+
+  size_type size() const {
+    sortAndDeduplicate();
+    return Replaces.size();
+  }
+
+  const_iterator begin() const {
+    sortAndDeduplicate();
+    return Replaces.begin();
+  }
+
+  const_iterator end() const {
+    sortAndDeduplicate();
+    return Replaces.end();
+  }
+
+  /// \brief Returns the replacements whose range overlaps with the range of
+  /// an earlier replacement in the same file, in order.
+  std::vector<Replacement> getConflicts() const;
+
+private:
+  void sortAndDeduplicate() const;
+
+  /// \brief Drops the duplicates once the unsorted tail outgrows the sorted
+  /// prefix, so that inserting many duplicates, e.g. the same header
+  /// replacements from many translation units, takes memory proportional to
+  /// the number of distinct replacements at amortized O(log n) per insertion.
+  void compactIfNeeded() {
+    if (Replaces.size() - NumSorted > std::max<size_type>(NumSorted, 1024))
+      sortAndDeduplicate();
+  }
+
+  /// \brief The replacements; only the first \c NumSorted are sorted and
+  /// unique.
+  mutable std::vector<Replacement> Replaces;
+  mutable size_type NumSorted;
+};
 
 /// \brief Apply all replacements in \p Replaces to the Rewriter \p Rewrite.
 ///
@@ -0,0 +1,107 @@
+//===-- ReplacementsExport.h - Streaming export of replacements -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Writes the replacements of each translation unit to its own YAML
+/// document as soon as the translation unit is processed, and merges such
+/// documents back into a single set of replacements.
+///
+/// Large refactorings that keep the replacements of all translation units in
+/// memory until the tool finishes do not scale to big code bases; exporting
+/// per translation unit keeps the memory of the tool bounded by a single
+/// translation unit, and merging keeps it bounded by the number of distinct
+/// replacements.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_REPLACEMENTS_EXPORT_H
+#define LLVM_CLANG_TOOLING_REPLACEMENTS_EXPORT_H
+
+#include "clang/Tooling/Refactoring.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace clang {
+
+class FrontendAction;
+
+namespace tooling {
+
+/// \brief Writes \p Doc to a YAML file in \p Directory.
+///
+/// The file name is derived from \c Doc.MainSourceFile and \p Configuration,
+/// so exporting the replacements of the same main file twice overwrites the
+/// earlier document unless the configurations differ. The document is written
+/// to a temporary file that is then renamed, so readers never see a partially
+/// written document.
+///
+/// \param Configuration Identifies how the main file was built, for main
+/// files built by several compile commands.
+///
+/// \returns true on success; otherwise, \p ErrorMessage describes the error.
+bool exportReplacements(TranslationUnitReplacements &Doc,
+                        StringRef Directory, std::string &ErrorMessage,
+                        StringRef Configuration = "");
+
+/// \brief Reads all YAML documents written by \c exportReplacements to
+/// \p Directory and adds their replacements to \p Merged.
+///
+/// Documents are read one at a time and replacements that several translation
+/// units share, e.g. those in headers, are only kept once, so the memory used
+/// is bounded by the number of distinct replacements rather than by the
+/// number of translation units.
+///
+/// \returns true on success; otherwise, \p ErrorMessage describes the error.
+bool mergeExportedReplacements(StringRef Directory, Replacements &Merged,
+                               std::string &ErrorMessage);
+
+/// \brief Interface to generate FrontendActions that add the replacements
+/// for a translation unit to a given set.
+class RefactoringActionFactory {
+public:
+  virtual ~RefactoringActionFactory();
+
+  /// \brief Returns a new FrontendAction that adds its replacements to
+  /// \p Replaces.
+  ///
+  /// The caller takes ownership of the returned action. \p Replaces outlives
+  /// the action.
+  virtual FrontendAction *create(Replacements &Replaces) = 0;
+};
+
+/// \brief A ToolAction that runs the actions created by a
+/// \c RefactoringActionFactory and exports the replacements of each
+/// translation unit as soon as it is processed.
+///
+/// Each translation unit gets its own set of replacements, so the action can
+/// be used with \c ClangTool::runInParallel as long as \p Factory can. A main
+/// file built by several compile commands gets a document per configuration,
+/// i.e. per set of language options, target, macros and include paths;
+/// commands that differ in nothing else share a document.
+class ExportReplacementsAction : public ToolAction {
+public:
+  /// \param Factory Creates the actions to run; not owned.
+  /// \param Directory The directory to write the YAML documents to.
+  /// \param Context Stored in the \c Context field of each document.
+  ExportReplacementsAction(RefactoringActionFactory *Factory,
+                           StringRef Directory, StringRef Context = "");
+
+  bool runInvocation(CompilerInvocation *Invocation, FileManager *Files,
+                     DiagnosticConsumer *DiagConsumer) override;
+
+private:
+  RefactoringActionFactory *Factory;
+  std::string Directory;
+  std::string Context;
+};
+
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_REPLACEMENTS_EXPORT_H
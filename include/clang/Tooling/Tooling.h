@@ -282,6 +282,26 @@ class ClangTool {
   /// \param Action Tool action.
   int run(ToolAction *Action);
 
+  /// \brief Runs an action over all files specified in the command line,
+  /// processing several files concurrently.
+  ///
+  /// Unlike run(), this does not change the working directory of the process:
+  /// each worker thread resolves relative paths through a FileManager of its
+  /// own, rooted at the directory of the compile command. The shared file
+  /// manager returned by getFiles() is not used.
+  ///
+  /// \p Action is invoked concurrently from several threads and must be
+  /// thread-safe, as must anything it stores its results into. The diagnostic
+  /// consumer set with setDiagnosticConsumer() is called by one thread at a
+  /// time, but sees the source files of different translation units
+  /// interleaved. Without a consumer, the diagnostics of each file are printed
+  /// together once the file has been processed.
+  ///
+  /// \param Action Tool action.
+  /// \param NumThreads The number of worker threads to use, or 0 to use one
+  ///        per hardware thread.
+  int runInParallel(ToolAction *Action, unsigned NumThreads = 0);
+
   /// \brief Create an AST for each file specified in the command line and
   /// append them to ASTs.
   int buildASTs(std::vector<std::unique_ptr<ASTUnit>> &ASTs);
@@ -292,6 +312,12 @@ class ClangTool {
   FileManager &getFiles() { return *Files; }
 
  private:
+  /// \brief Returns the command line for \p Command after applying the
+  /// arguments adjusters, invoking \p MainExecutable.
+  std::vector<std::string>
+  getAdjustedCommandLine(const CompileCommand &Command,
+                         StringRef MainExecutable) const;
+
   // We store compile commands as pair (file name, compile command).
   std::vector< std::pair<std::string, CompileCommand> > CompileCommands;
 
@@ -19,6 +19,7 @@
 #include "clang/AST/Comment.h"
 #include "clang/AST/CommentCommandTraits.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclContextInternals.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
@@ -863,6 +864,26 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  // Name lookup tables of declaration contexts.
+  unsigned NumLookupTables = 0, NumLookupEntries = 0, NumOverloadedNames = 0;
+  size_t LookupTableBytes = 0;
+  for (StoredDeclsMap *Map = LastSDM.getPointer(); Map;
+       Map = Map->Previous.getPointer()) {
+    ++NumLookupTables;
+    NumLookupEntries += Map->size();
+    LookupTableBytes += Map->getMemorySize();
+    for (StoredDeclsMap::iterator I = Map->begin(), E = Map->end(); I != E;
+         ++I)
+      if (StoredDeclsList::DeclsTy *Vec = I->second.getAsVector()) {
+        ++NumOverloadedNames;
+        LookupTableBytes += sizeof(*Vec);
+      }
+  }
+  llvm::errs() << NumLookupTables << " name lookup tables, with "
+               << NumLookupEntries << " names (" << NumOverloadedNames
+               << " with several declarations) in " << LookupTableBytes
+               << " bytes\n";
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -1240,6 +1240,41 @@ static bool shouldBeHidden(NamedDecl *D) {
   return false;
 }
 
+/// isAddedToBuiltLookup - Determine whether buildLookup adds the declaration
+/// ND, found in DCtx, to the lookup data structure of DC.
+static bool isAddedToBuiltLookup(const DeclContext *DC, const DeclContext *DCtx,
+                                 NamedDecl *ND) {
+  // Only add declarations that are semantically within their decl context.
+  // Any other decls which should be found in this context are added eagerly.
+  //
+  // If it's from an AST file, don't add it now. It'll get handled by
+  // FindExternalVisibleDeclsByName if needed. Exception: if we're not
+  // in C++, we do not track external visible decls for the TU, so in
+  // that case we need to collect them all here.
+  return ND->getDeclContext() == DCtx && !shouldBeHidden(ND) &&
+         (!ND->isFromASTFile() ||
+          (DC->isTranslationUnit() &&
+           !DC->getParentASTContext().getLangOpts().CPlusPlus));
+}
+
+/// countDeclsForLookup - Count the declarations that buildLookup adds to the
+/// lookup data structure of DC from DCtx. This is an upper bound on the
+/// number of names they add.
+static unsigned countDeclsForLookup(const DeclContext *DC,
+                                    const DeclContext *DCtx) {
+  unsigned NumDecls = 0;
+  for (Decl *D : DCtx->decls()) {
+    if (NamedDecl *ND = dyn_cast<NamedDecl>(D))
+      if (isAddedToBuiltLookup(DC, DCtx, ND))
+        ++NumDecls;
+
+    if (DeclContext *InnerCtx = dyn_cast<DeclContext>(D))
+      if (InnerCtx->isTransparentContext() || InnerCtx->isInlineNamespace())
+        NumDecls += countDeclsForLookup(DC, InnerCtx);
+  }
+  return NumDecls;
+}
+
 /// buildLookup - Build the lookup data structure with all of the
 /// declarations in this DeclContext (and any other contexts linked
 /// to it or transparent contexts nested within it) and return it.
@@ -1256,6 +1291,22 @@ StoredDeclsMap *DeclContext::buildLookup() {
 
   SmallVector<DeclContext *, 2> Contexts;
   collectAllContexts(Contexts);
+
+  // Size the lookup table for all of the declarations up front, rather than
+  // growing and rehashing it repeatedly while it is built: this dominates the
+  // first lookup into namespaces and classes with many thousands of members,
+  // and growing a table briefly needs both its old and new buckets.
+  unsigned NumDecls = 0;
+  for (unsigned I = 0, N = Contexts.size(); I != N; ++I)
+    NumDecls += countDeclsForLookup(this, Contexts[I]);
+  if (NumDecls > 64) {
+    StoredDeclsMap *Map = LookupPtr.getPointer();
+    if (!Map)
+      Map = CreateStoredDeclsMap(getParentASTContext());
+    // Keep the load factor below the 3/4 at which the table would grow.
+    Map->resize((Map->size() + NumDecls) * 4 / 3 + 1);
+  }
+
   for (unsigned I = 0, N = Contexts.size(); I != N; ++I)
     buildLookupImpl<&DeclContext::decls_begin,
                     &DeclContext::decls_end>(Contexts[I]);
@@ -1276,19 +1327,9 @@ void DeclContext::buildLookupImpl(DeclContext *DCtx) {
        I != E; ++I) {
     Decl *D = *I;
 
-    // Insert this declaration into the lookup structure, but only if
-    // it's semantically within its decl context. Any other decls which
-    // should be found in this context are added eagerly.
-    //
-    // If it's from an AST file, don't add it now. It'll get handled by
-    // FindExternalVisibleDeclsByName if needed. Exception: if we're not
-    // in C++, we do not track external visible decls for the TU, so in
-    // that case we need to collect them all here.
+    // Insert this declaration into the lookup structure, if it belongs there.
     if (NamedDecl *ND = dyn_cast<NamedDecl>(D))
-      if (ND->getDeclContext() == DCtx && !shouldBeHidden(ND) &&
-          (!ND->isFromASTFile() ||
-           (isTranslationUnit() &&
-            !getParentASTContext().getLangOpts().CPlusPlus)))
+      if (isAddedToBuiltLookup(this, DCtx, ND))
         makeDeclVisibleInContextImpl(ND, false);
 
     // If this declaration is itself a transparent declaration context
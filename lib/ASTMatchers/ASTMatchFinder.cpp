@@ -20,7 +20,12 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/RecursiveASTVisitor.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <deque>
+#include <list>
 #include <set>
 
 namespace clang {
@@ -69,6 +74,51 @@ struct MemoizedMatchResult {
   BoundNodesTreeBuilder Nodes;
 };
 
+// Maps (matcher, node) -> the match result for memoization.
+//
+// Holds at most MaxMemoizationEntries results; when full, the result that was
+// looked up least recently is dropped.
+class MemoizationMap {
+public:
+  // Returns the result stored for \p Key, or null. The result is only valid
+  // until the next call to insert().
+  const MemoizedMatchResult *find(const MatchKey &Key) {
+    ResultMap::iterator I = Results.find(Key);
+    if (I == Results.end())
+      return nullptr;
+    UseOrder.splice(UseOrder.begin(), UseOrder, I->second.Use);
+    return &I->second.Result;
+  }
+
+  void insert(const MatchKey &Key, const MemoizedMatchResult &Result) {
+    std::pair<ResultMap::iterator, bool> Inserted =
+        Results.insert(std::make_pair(Key, Entry()));
+    Entry &E = Inserted.first->second;
+    E.Result = Result;
+    if (!Inserted.second) {
+      UseOrder.splice(UseOrder.begin(), UseOrder, E.Use);
+      return;
+    }
+    UseOrder.push_front(&Inserted.first->first);
+    E.Use = UseOrder.begin();
+    if (Results.size() > MaxMemoizationEntries) {
+      Results.erase(*UseOrder.back());
+      UseOrder.pop_back();
+    }
+  }
+
+private:
+  struct Entry {
+    MemoizedMatchResult Result;
+    std::list<const MatchKey *>::iterator Use;
+  };
+  typedef std::map<MatchKey, Entry> ResultMap;
+
+  ResultMap Results;
+  // The keys of Results, most recently used first.
+  std::list<const MatchKey *> UseOrder;
+};
+
 // A RecursiveASTVisitor that traverses all children or all descendants of
 // a node.
 class MatchChildASTVisitor
@@ -294,8 +344,21 @@ class MatchASTVisitor : public RecursiveASTVisitor<MatchASTVisitor>,
 public:
   MatchASTVisitor(
       std::vector<std::pair<internal::DynTypedMatcher, MatchCallback *> > *
-          MatcherCallbackPairs)
-      : MatcherCallbackPairs(MatcherCallbackPairs), ActiveASTContext(nullptr) {}
+          MatcherCallbackPairs,
+      const MatchFinder::MatchFinderOptions &Options)
+      : MatcherCallbackPairs(MatcherCallbackPairs), ActiveASTContext(nullptr),
+        CurrentProfile(nullptr), TraversalDepth(0) {
+    if (!Options.ProfileRecords)
+      return;
+    llvm::StringMap<MatcherProfile> &Records = *Options.ProfileRecords;
+    for (unsigned I = 0, E = MatcherCallbackPairs->size(); I != E; ++I) {
+      StringRef ID = (*MatcherCallbackPairs)[I].second->getID();
+      std::string Key =
+          ID.empty() ? "matcher #" + llvm::utostr(I) : ID.str();
+      // StringMap values do not move when the map grows.
+      Profiles.push_back(&Records[Key]);
+    }
+  }
 
   void onStartOfTranslationUnit() {
     for (std::vector<std::pair<internal::DynTypedMatcher,
@@ -371,6 +434,8 @@ public:
                                   const DynTypedMatcher &Matcher,
                                   BoundNodesTreeBuilder *Builder, int MaxDepth,
                                   TraversalKind Traversal, BindKind Bind) {
+    TraversalTimer Timer(*this);
+
     // For AST-nodes that don't have an identity, we can't memoize.
     if (!Node.getMemoizationData())
       return matchesRecursively(Node, Matcher, Builder, MaxDepth, Traversal,
@@ -382,17 +447,20 @@ public:
     // Note that we key on the bindings *before* the match.
     Key.BoundNodes = *Builder;
 
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    if (const MemoizedMatchResult *Cached = ResultCache.find(Key)) {
+      if (CurrentProfile)
+        ++CurrentProfile->CacheHits;
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
+    if (CurrentProfile)
+      ++CurrentProfile->CacheMisses;
     MemoizedMatchResult Result;
     Result.Nodes = *Builder;
     Result.ResultOfMatch = matchesRecursively(Node, Matcher, &Result.Nodes,
                                               MaxDepth, Traversal, Bind);
-    ResultCache[Key] = Result;
+    ResultCache.insert(Key, Result);
     *Builder = Result.Nodes;
     return Result.ResultOfMatch;
   }
@@ -417,8 +485,6 @@ public:
                       BoundNodesTreeBuilder *Builder,
                       TraversalKind Traversal,
                       BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesRecursively(Node, Matcher, Builder, 1, Traversal,
                                       Bind);
   }
@@ -427,8 +493,6 @@ public:
                            const DynTypedMatcher &Matcher,
                            BoundNodesTreeBuilder *Builder,
                            BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesRecursively(Node, Matcher, Builder, INT_MAX,
                                       TK_AsIs, Bind);
   }
@@ -437,25 +501,36 @@ public:
                          const DynTypedMatcher &Matcher,
                          BoundNodesTreeBuilder *Builder,
                          AncestorMatchMode MatchMode) override {
-    // Reset the cache outside of the recursive call to make sure we
-    // don't invalidate any iterators.
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    TraversalTimer Timer(*this);
     return memoizedMatchesAncestorOfRecursively(Node, Matcher, Builder,
                                                 MatchMode);
   }
 
-  // Matches all registered matchers on the given node and calls the
-  // result callback for every node that matches.
+  // Matches all registered matchers that can match the given node and calls
+  // the result callback for every node that matches.
   void match(const ast_type_traits::DynTypedNode& Node) {
-    for (std::vector<std::pair<internal::DynTypedMatcher,
-                               MatchCallback *> >::const_iterator
-             I = MatcherCallbackPairs->begin(),
-             E = MatcherCallbackPairs->end();
-         I != E; ++I) {
+    const std::vector<unsigned> &Filter = getFilterForKind(getNodeKind(Node));
+    for (unsigned Index : Filter) {
+      const std::pair<internal::DynTypedMatcher, MatchCallback *> &MP =
+          (*MatcherCallbackPairs)[Index];
       BoundNodesTreeBuilder Builder;
-      if (I->first.matches(Node, this, &Builder)) {
-        MatchVisitor Visitor(ActiveASTContext, I->second);
+      bool Matched;
+      if (Profiles.empty()) {
+        Matched = MP.first.matches(Node, this, &Builder);
+      } else {
+        CurrentProfile = Profiles[Index];
+        ++CurrentProfile->Invocations;
+        llvm::TimeRecord Time;
+        Time -= llvm::TimeRecord::getCurrentTime(true);
+        Matched = MP.first.matches(Node, this, &Builder);
+        Time += llvm::TimeRecord::getCurrentTime(false);
+        CurrentProfile->Time += Time;
+        if (Matched)
+          ++CurrentProfile->Matches;
+        CurrentProfile = nullptr;
+      }
+      if (Matched) {
+        MatchVisitor Visitor(ActiveASTContext, MP.second);
         Builder.visitMatches(&Visitor);
       }
     }
@@ -475,6 +550,53 @@ public:
   bool shouldUseDataRecursionFor(clang::Stmt *S) const { return false; }
 
 private:
+  // Adds the time spent in the outermost nested traversal of the matcher
+  // being profiled to its TraversalTime.
+  class TraversalTimer {
+  public:
+    TraversalTimer(MatchASTVisitor &Visitor) : Visitor(Visitor) {
+      if (Visitor.CurrentProfile && Visitor.TraversalDepth++ == 0)
+        Time -= llvm::TimeRecord::getCurrentTime(true);
+    }
+    ~TraversalTimer() {
+      if (Visitor.CurrentProfile && --Visitor.TraversalDepth == 0) {
+        Time += llvm::TimeRecord::getCurrentTime(false);
+        Visitor.CurrentProfile->TraversalTime += Time;
+      }
+    }
+
+  private:
+    MatchASTVisitor &Visitor;
+    llvm::TimeRecord Time;
+  };
+
+  // Returns the most derived kind known for \p Node.
+  static ast_type_traits::ASTNodeKind
+  getNodeKind(const ast_type_traits::DynTypedNode &Node) {
+    if (const Decl *D = Node.get<Decl>())
+      return ast_type_traits::ASTNodeKind::getFromNode(*D);
+    if (const Stmt *S = Node.get<Stmt>())
+      return ast_type_traits::ASTNodeKind::getFromNode(*S);
+    return Node.getNodeKind();
+  }
+
+  // Returns the indices of the matchers in MatcherCallbackPairs that can match
+  // nodes of kind \p Kind, in the order they were added.
+  const std::vector<unsigned> &
+  getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
+    auto I = MatcherFiltersMap.find(Kind);
+    if (I != MatcherFiltersMap.end())
+      return I->second;
+    std::vector<unsigned> &Filter = MatcherFiltersMap[Kind];
+    for (unsigned Index = 0, E = MatcherCallbackPairs->size(); Index != E;
+         ++Index) {
+      if ((*MatcherCallbackPairs)[Index].first.getRestrictKind().isBaseOf(
+              Kind))
+        Filter.push_back(Index);
+    }
+    return Filter;
+  }
+
   // Returns whether an ancestor of \p Node matches \p Matcher.
   //
   // The order of matching ((which can lead to different nodes being bound in
@@ -507,13 +629,16 @@ private:
     Key.Node = Node;
     Key.BoundNodes = *Builder;
 
-    // Note that we cannot use insert and reuse the iterator, as recursive
-    // calls to match might invalidate the result cache iterators.
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    // Note that we cannot keep the cached result, as recursive calls to match
+    // might drop it from the result cache.
+    if (const MemoizedMatchResult *Cached = ResultCache.find(Key)) {
+      if (CurrentProfile)
+        ++CurrentProfile->CacheHits;
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
+    if (CurrentProfile)
+      ++CurrentProfile->CacheMisses;
     MemoizedMatchResult Result;
     Result.ResultOfMatch = false;
     Result.Nodes = *Builder;
@@ -558,7 +683,7 @@ private:
         Queue.pop_front();
       }
     }
-    ResultCache[Key] = Result;
+    ResultCache.insert(Key, Result);
 
     *Builder = Result.Nodes;
     return Result.ResultOfMatch;
@@ -609,9 +734,18 @@ private:
   // Maps a canonical type to its TypedefDecls.
   llvm::DenseMap<const Type*, std::set<const TypedefNameDecl*> > TypeAliases;
 
-  // Maps (matcher, node) -> the match result for memoization.
-  typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
+  // Maps a node kind to the matchers that can match nodes of that kind.
+  std::map<ast_type_traits::ASTNodeKind, std::vector<unsigned> >
+      MatcherFiltersMap;
+
   MemoizationMap ResultCache;
+
+  // The profiling records of MatcherCallbackPairs, if profiling is enabled.
+  std::vector<MatcherProfile *> Profiles;
+  // The record of the top-level matcher being run, if profiling is enabled.
+  MatcherProfile *CurrentProfile;
+  // The number of nested traversals in progress for CurrentProfile.
+  unsigned TraversalDepth;
 };
 
 static CXXRecordDecl *getAsCXXRecordDecl(const Type *TypeNode) {
@@ -765,7 +899,8 @@ MatchFinder::MatchResult::MatchResult(const BoundNodes &Nodes,
 MatchFinder::MatchCallback::~MatchCallback() {}
 MatchFinder::ParsingDoneTestCallback::~ParsingDoneTestCallback() {}
 
-MatchFinder::MatchFinder() : ParsingDone(nullptr) {}
+MatchFinder::MatchFinder(MatchFinderOptions Options)
+    : Options(Options), ParsingDone(nullptr) {}
 
 MatchFinder::~MatchFinder() {}
 
@@ -829,19 +964,47 @@ ASTConsumer *MatchFinder::newASTConsumer() {
 
 void MatchFinder::match(const clang::ast_type_traits::DynTypedNode &Node,
                         ASTContext &Context) {
-  internal::MatchASTVisitor Visitor(&MatcherCallbackPairs);
+  internal::MatchASTVisitor Visitor(&MatcherCallbackPairs, Options);
   Visitor.set_active_ast_context(&Context);
   Visitor.match(Node);
 }
 
 void MatchFinder::matchAST(ASTContext &Context) {
-  internal::MatchASTVisitor Visitor(&MatcherCallbackPairs);
+  internal::MatchASTVisitor Visitor(&MatcherCallbackPairs, Options);
   Visitor.set_active_ast_context(&Context);
   Visitor.onStartOfTranslationUnit();
   Visitor.TraverseDecl(Context.getTranslationUnitDecl());
   Visitor.onEndOfTranslationUnit();
 }
 
+void printMatcherProfiles(const llvm::StringMap<MatcherProfile> &Profiles,
+                          raw_ostream &OS) {
+  std::vector<const llvm::StringMapEntry<MatcherProfile> *> Sorted;
+  for (const auto &Entry : Profiles)
+    Sorted.push_back(&Entry);
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const llvm::StringMapEntry<MatcherProfile> *LHS,
+               const llvm::StringMapEntry<MatcherProfile> *RHS) {
+    double LHSTime = LHS->getValue().Time.getProcessTime();
+    double RHSTime = RHS->getValue().Time.getProcessTime();
+    if (LHSTime != RHSTime)
+      return LHSTime > RHSTime;
+    return LHS->getKey() < RHS->getKey();
+  });
+
+  OS << "   ---Time---  --Traversal--  Invocations      Matches   Cache hits"
+        " Cache misses  Matcher\n";
+  for (const auto *Entry : Sorted) {
+    const MatcherProfile &Profile = Entry->getValue();
+    OS << llvm::format("  %10.4fs  %12.4fs  %11u  %11u  %11u  %11u",
+                       Profile.Time.getProcessTime(),
+                       Profile.TraversalTime.getProcessTime(),
+                       Profile.Invocations, Profile.Matches, Profile.CacheHits,
+                       Profile.CacheMisses)
+       << "  " << Entry->getKey() << "\n";
+  }
+}
+
 void MatchFinder::registerTestCallbackAfterParsing(
     MatchFinder::ParsingDoneTestCallback *NewParsingDone) {
   ParsingDone = NewParsingDone;
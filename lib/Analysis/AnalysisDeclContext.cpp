@@ -27,9 +27,11 @@
 #include "clang/Analysis/CFGStmtMap.h"
 #include "clang/Analysis/Support/BumpVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 using namespace clang;
 
@@ -70,7 +72,7 @@ AnalysisDeclContextManager::AnalysisDeclContextManager(bool useUnoptimizedCFG,
                                                        bool synthesizeBodies,
                                                        bool addStaticInitBranch,
                                                        bool addCXXNewAllocator)
-  : SynthesizeBodies(synthesizeBodies)
+  : UseCounter(0), SynthesizeBodies(synthesizeBodies)
 {
   cfgBuildOptions.PruneTriviallyFalseEdges = !useUnoptimizedCFG;
   cfgBuildOptions.AddImplicitDtors = addImplicitDtors;
@@ -80,8 +82,29 @@ AnalysisDeclContextManager::AnalysisDeclContextManager(bool useUnoptimizedCFG,
   cfgBuildOptions.AddCXXNewAllocator = addCXXNewAllocator;
 }
 
-void AnalysisDeclContextManager::clear() {
-  llvm::DeleteContainerSeconds(Contexts);
+void AnalysisDeclContextManager::clear(unsigned NumToKeep) {
+  if (Contexts.size() <= NumToKeep)
+    return;
+
+  if (NumToKeep == 0) {
+    llvm::DeleteContainerSeconds(Contexts);
+    LastUse.clear();
+    return;
+  }
+
+  SmallVector<std::pair<unsigned, const Decl *>, 64> ByLastUse;
+  for (ContextMap::iterator I = Contexts.begin(), E = Contexts.end(); I != E;
+       ++I)
+    ByLastUse.push_back(std::make_pair(LastUse.lookup(I->first), I->first));
+  std::sort(ByLastUse.begin(), ByLastUse.end());
+
+  for (unsigned I = 0, E = ByLastUse.size() - NumToKeep; I != E; ++I) {
+    const Decl *D = ByLastUse[I].second;
+    ContextMap::iterator It = Contexts.find(D);
+    delete It->second;
+    Contexts.erase(It);
+    LastUse.erase(D);
+  }
 }
 
 static BodyFarm &getBodyFarm(ASTContext &C) {
@@ -273,6 +296,7 @@ AnalysisDeclContext *AnalysisDeclContextManager::getContext(const Decl *D) {
     D = FD;
   }
 
+  LastUse[D] = ++UseCounter;
   AnalysisDeclContext *&AC = Contexts[D];
   if (!AC)
     AC = new AnalysisDeclContext(this, D, cfgBuildOptions);
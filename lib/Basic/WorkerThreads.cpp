@@ -0,0 +1,37 @@
+//===--- WorkerThreads.cpp - Run Work on a Set of Threads -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements runOnWorkerThreads.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/WorkerThreads.h"
+#include "llvm/Config/llvm-config.h"
+#include <thread>
+#include <vector>
+
+void clang::runOnWorkerThreads(const std::function<void()> &Worker,
+                               unsigned NumThreads, unsigned NumItems) {
+#if LLVM_ENABLE_THREADS
+  if (NumThreads == 0)
+    NumThreads = std::thread::hardware_concurrency();
+  if (NumThreads > NumItems)
+    NumThreads = NumItems;
+
+  // The calling thread is one of the workers.
+  std::vector<std::thread> Workers;
+  for (unsigned I = 1; I < NumThreads; ++I)
+    Workers.push_back(std::thread(Worker));
+  Worker();
+  for (auto &Thread : Workers)
+    Thread.join();
+#else
+  Worker();
+#endif
+}
@@ -580,26 +580,30 @@ llvm::DIType CGDebugInfo::CreateType(const PointerType *Ty,
 
 /// In C++ mode, types have linkage, so we can rely on the ODR and
 /// on their mangled names, if they're external.
-static SmallString<256>
-getUniqueTagTypeName(const TagType *Ty, CodeGenModule &CGM,
-                     llvm::DICompileUnit TheCU) {
-  SmallString<256> FullName;
+StringRef CGDebugInfo::getTypeIdentifier(const TagType *Ty) {
+  const TagDecl *TD = Ty->getDecl();
+  auto I = TypeIdentifierCache.find(TD);
+  if (I != TypeIdentifierCache.end())
+    return I->second;
+
+  StringRef &Identifier = TypeIdentifierCache[TD];
   // FIXME: ODR should apply to ObjC++ exactly the same wasy it does to C++.
   // For now, only apply ODR with C++.
-  const TagDecl *TD = Ty->getDecl();
   if (TheCU.getLanguage() != llvm::dwarf::DW_LANG_C_plus_plus ||
       !TD->isExternallyVisible())
-    return FullName;
+    return Identifier;
   // Microsoft Mangler does not have support for mangleCXXRTTIName yet.
   if (CGM.getTarget().getCXXABI().isMicrosoft())
-    return FullName;
+    return Identifier;
 
   // TODO: This is using the RTTI name. Is there a better way to get
   // a unique string for a type?
+  SmallString<256> FullName;
   llvm::raw_svector_ostream Out(FullName);
   CGM.getCXXABI().getMangleContext().mangleCXXRTTIName(QualType(Ty, 0), Out);
   Out.flush();
-  return FullName;
+  Identifier = internString(FullName);
+  return Identifier;
 }
 
 // Creates a forward declaration for a RecordDecl in the given context.
@@ -624,7 +628,7 @@ CGDebugInfo::getOrCreateRecordFwdDecl(const RecordType *Ty,
   }
 
   // Create the type.
-  SmallString<256> FullName = getUniqueTagTypeName(Ty, CGM, TheCU);
+  StringRef FullName = getTypeIdentifier(Ty);
   llvm::DICompositeType RetTy = DBuilder.createReplaceableForwardDecl(
       Tag, RDName, Ctx, DefUnit, Line, 0, 0, 0, FullName);
   ReplaceMap.push_back(std::make_pair(Ty, static_cast<llvm::Value *>(RetTy)));
@@ -1918,7 +1922,7 @@ llvm::DIType CGDebugInfo::CreateEnumType(const EnumType *Ty) {
     Align = CGM.getContext().getTypeAlign(ED->getTypeForDecl());
   }
 
-  SmallString<256> FullName = getUniqueTagTypeName(Ty, CGM, TheCU);
+  StringRef FullName = getTypeIdentifier(Ty);
 
   // If this is just a forward declaration, construct an appropriately
   // marked node and just return it.
@@ -1947,7 +1951,7 @@ llvm::DIType CGDebugInfo::CreateTypeDefinition(const EnumType *Ty) {
     Align = CGM.getContext().getTypeAlign(ED->getTypeForDecl());
   }
 
-  SmallString<256> FullName = getUniqueTagTypeName(Ty, CGM, TheCU);
+  StringRef FullName = getTypeIdentifier(Ty);
 
   // Create DIEnumerator elements for each enumerator.
   SmallVector<llvm::Value *, 16> Enumerators;
@@ -2249,7 +2253,7 @@ llvm::DICompositeType CGDebugInfo::CreateLimitedType(const RecordType *Ty) {
   uint64_t Align = CGM.getContext().getTypeAlign(Ty);
   llvm::DICompositeType RealDecl;
 
-  SmallString<256> FullName = getUniqueTagTypeName(Ty, CGM, TheCU);
+  StringRef FullName = getTypeIdentifier(Ty);
 
   if (RD->isUnion())
     RealDecl = DBuilder.createUnionType(RDContext, RDName, DefUnit, Line,
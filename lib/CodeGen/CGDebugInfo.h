@@ -109,6 +109,12 @@ class CGDebugInfo {
   llvm::DenseMap<const NamespaceAliasDecl *, llvm::WeakVH> NamespaceAliasCache;
   llvm::DenseMap<const Decl *, llvm::WeakVH> StaticDataMemberCache;
 
+  /// TypeIdentifierCache - Cache of the ODR type identifiers computed for tag
+  /// types. The identifier keys the type in the debug info and is what the
+  /// backend hashes into a type unit signature, so it is computed only once
+  /// per type in this TU.
+  llvm::DenseMap<const TagDecl *, StringRef> TypeIdentifierCache;
+
   /// Helper functions for getOrCreateType.
   unsigned Checksum(const ObjCInterfaceDecl *InterfaceDecl);
   llvm::DIType CreateType(const BuiltinType *Ty);
@@ -392,6 +398,10 @@ private:
   /// getClassName - Get class name including template argument list.
   StringRef getClassName(const RecordDecl *RD);
 
+  /// getTypeIdentifier - Get the unique ODR identifier of the given tag type,
+  /// or an empty string if the type has none.
+  StringRef getTypeIdentifier(const TagType *Ty);
+
   /// getVTableName - Get vtable name for the given Class.
   StringRef getVTableName(const CXXRecordDecl *Decl);
 
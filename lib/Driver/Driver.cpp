@@ -58,7 +58,8 @@ Driver::Driver(StringRef ClangExecutable,
     CCLogDiagnosticsFilename(nullptr),
     CCCPrintBindings(false),
     CCPrintHeaders(false), CCLogDiagnostics(false),
-    CCGenDiagnostics(false), CCCGenericGCCName(""), CheckInputsExist(true),
+    CCGenDiagnostics(false), CC1Main(nullptr), CCCGenericGCCName(""),
+    CheckInputsExist(true),
     CCCUsePCH(true), SuppressMissingInputWarning(false) {
 
   Name = llvm::sys::path::stem(ClangExecutable);
@@ -1611,6 +1612,20 @@ void Driver::BuildJobs(Compilation &C) const {
                        II);
   }
 
+  // The frontend keeps process-wide state (command line options, statistics,
+  // fatal error handlers), so only run it in-process if there is a single -cc1
+  // job in this compilation.
+  unsigned NumCC1Jobs = 0;
+  for (JobList::iterator it = C.getJobs().begin(), ie = C.getJobs().end();
+       it != ie; ++it)
+    if (isa<CC1Command>(*it))
+      ++NumCC1Jobs;
+  if (NumCC1Jobs > 1)
+    for (JobList::iterator it = C.getJobs().begin(), ie = C.getJobs().end();
+         it != ie; ++it)
+      if (CC1Command *CC1 = dyn_cast<CC1Command>(*it))
+        CC1->setInProcess(false);
+
   // If the user passed -Qunused-arguments or there were errors, don't warn
   // about any unused arguments.
   if (Diags.hasErrorOccurred() ||
@@ -31,6 +31,12 @@ Command::Command(const Action &_Source, const Tool &_Creator,
     : Job(CommandClass), Source(_Source), Creator(_Creator),
       Executable(_Executable), Arguments(_Arguments) {}
 
+Command::Command(JobClass _Kind, const Action &_Source, const Tool &_Creator,
+                 const char *_Executable,
+                 const ArgStringList &_Arguments)
+    : Job(_Kind), Source(_Source), Creator(_Creator),
+      Executable(_Executable), Arguments(_Arguments) {}
+
 static int skipArgs(const char *Flag) {
   // These flags are all of the form -Flag <Arg> and are treated as two
   // arguments.  Therefore, we need to skip the flag and the next argument.
@@ -132,6 +138,33 @@ int Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
                                    /*memoryLimit*/ 0, ErrMsg, ExecutionFailed);
 }
 
+CC1Command::CC1Command(const Action &Source_, const Tool &Creator_,
+                       const char *Executable_,
+                       const ArgStringList &Arguments_)
+    : Command(CC1CommandClass, Source_, Creator_, Executable_, Arguments_),
+      InProcess(true) {}
+
+int CC1Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
+                        bool *ExecutionFailed) const {
+  const Driver &D = getCreator().getToolChain().getDriver();
+
+  // Commands with redirected output (e.g. when generating crash diagnostics)
+  // always get a process of their own.
+  if (!InProcess || !D.CC1Main || Redirects)
+    return Command::Execute(Redirects, ErrMsg, ExecutionFailed);
+
+  SmallVector<const char*, 128> Argv;
+  Argv.push_back(getExecutable());
+  Argv.append(getArguments().begin(), getArguments().end());
+
+  if (ExecutionFailed)
+    *ExecutionFailed = false;
+
+  // CC1Main reports crashes and fatal errors like a child process would, so
+  // the driver can still generate crash diagnostics.
+  return D.CC1Main(Argv);
+}
+
 FallbackCommand::FallbackCommand(const Action &Source_, const Tool &Creator_,
                                  const char *Executable_,
                                  const ArgStringList &Arguments_,
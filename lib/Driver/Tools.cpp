@@ -4170,6 +4170,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_delayed_template_parsing, IsWindowsMSVC))
     CmdArgs.push_back("-fdelayed-template-parsing");
 
+  // -fno-pch-instantiate-templates is default.
+  if (Args.hasFlag(options::OPT_fpch_instantiate_templates,
+                   options::OPT_fno_pch_instantiate_templates, false))
+    CmdArgs.push_back("-fpch-instantiate-templates");
+
   // -fgnu-keywords default varies depending on language; only pass if
   // specified.
   if (Arg *A = Args.getLastArg(options::OPT_fgnu_keywords,
@@ -4619,6 +4624,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     Command *CLCommand = getCLFallback()->GetCommand(C, JA, Output, Inputs,
                                                      Args, LinkingOutput);
     C.addCommand(new FallbackCommand(JA, *this, Exec, CmdArgs, CLCommand));
+  } else if (D.CC1Main && !C.isForDiagnostics() &&
+             Args.hasFlag(options::OPT_fintegrated_cc1,
+                          options::OPT_fno_integrated_cc1, true)) {
+    // Invoke the frontend directly in the driver process.
+    C.addCommand(new CC1Command(JA, *this, Exec, CmdArgs));
   } else {
     C.addCommand(new Command(JA, *this, Exec, CmdArgs));
   }
@@ -82,6 +82,8 @@ LineState ContinuationIndenter::getInitialState(unsigned FirstIndent,
   State.StartOfLineLevel = 0;
   State.LowestLevelOnLine = 0;
   State.IgnoreStackForComparison = false;
+  State.HashWithStack = 0;
+  State.HashWithoutStack = 0;
 
   // The first token has already been indented and thus consumed.
   moveStateToNextToken(State, DryRun, /*Newline=*/false);
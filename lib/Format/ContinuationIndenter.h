@@ -18,6 +18,7 @@
 
 #include "Encoding.h"
 #include "clang/Format/Format.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Regex.h"
 
 namespace clang {
@@ -294,6 +295,27 @@ struct ParenState {
       return JSFunctionInlined < Other.JSFunctionInlined;
     return false;
   }
+
+  /// \brief Equality on the fields compared by \c operator<.
+  bool operator==(const ParenState &Other) const {
+    return !(*this < Other) && !(Other < *this);
+  }
+
+  /// \brief Hash of the fields compared by \c operator<.
+  friend llvm::hash_code hash_value(const ParenState &State) {
+    return llvm::hash_combine(
+        llvm::hash_combine(State.Indent, State.LastSpace, State.FirstLessLess,
+                           State.BreakBeforeClosingBrace, State.QuestionColumn,
+                           State.AvoidBinPacking),
+        llvm::hash_combine(State.BreakBeforeParameter, State.NoLineBreak,
+                           State.LastOperatorWrapped, State.ColonPos,
+                           State.StartOfFunctionCall,
+                           State.StartOfArraySubscripts),
+        llvm::hash_combine(State.CallContinuation, State.VariablePos,
+                           State.ContainsLineBreak,
+                           State.ContainsUnwrappedBuilder,
+                           State.JSFunctionInlined));
+  }
 };
 
 /// \brief The current state when indenting a unwrapped line.
@@ -365,6 +387,47 @@ struct LineState {
       return false;
     return Stack < Other.Stack;
   }
+
+  /// \brief Returns \c true if neither state is less than the other one,
+  /// comparing the \c ParenState stacks only if \p CompareStack is set.
+  ///
+  /// Unlike \c operator<, this does not look at \c IgnoreStackForComparison.
+  bool isEquivalentTo(const LineState &Other, bool CompareStack) const {
+    if (NextToken != Other.NextToken || Column != Other.Column ||
+        LineContainsContinuedForLoopSection !=
+            Other.LineContainsContinuedForLoopSection ||
+        StartOfLineLevel != Other.StartOfLineLevel ||
+        LowestLevelOnLine != Other.LowestLevelOnLine ||
+        StartOfStringLiteral != Other.StartOfStringLiteral)
+      return false;
+    return !CompareStack || Stack == Other.Stack;
+  }
+
+  /// \brief Hash consistent with \c isEquivalentTo, as computed by the last
+  /// call to \c computeHashes().
+  unsigned getHash(bool IncludeStack) const {
+    return IncludeStack ? HashWithStack : HashWithoutStack;
+  }
+
+  /// \brief Computes the hashes returned by \c getHash().
+  ///
+  /// Hashing the \c ParenState stack walks all of it, so a state is hashed
+  /// once, when it is added to the states examined by the solution space
+  /// search, and must not change afterwards. The stack is not hashed if it
+  /// is ignored for comparison.
+  void computeHashes() {
+    llvm::hash_code Hash = llvm::hash_combine(
+        NextToken, Column, LineContainsContinuedForLoopSection,
+        StartOfLineLevel, LowestLevelOnLine, StartOfStringLiteral);
+    HashWithoutStack = Hash;
+    if (!IgnoreStackForComparison)
+      HashWithStack = llvm::hash_combine(
+          Hash, llvm::hash_combine_range(Stack.begin(), Stack.end()));
+  }
+
+  /// \brief The hashes computed by \c computeHashes().
+  unsigned HashWithStack;
+  unsigned HashWithoutStack;
 };
 
 } // end namespace format
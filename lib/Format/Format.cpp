@@ -22,10 +22,16 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/Format/Format.h"
 #include "clang/Lex/Lexer.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MutexGuard.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/YAMLTraits.h"
 #include <queue>
 #include <string>
@@ -794,7 +800,16 @@ public:
                          WhitespaceManager *Whitespaces,
                          const FormatStyle &Style)
       : Indenter(Indenter), Whitespaces(Whitespaces), Style(Style),
-        Joiner(Style) {}
+        Joiner(Style), SearchDepth(0), Cache(nullptr), CacheSeed(0) {}
+
+  /// \brief Looks up and records the formatting of lines in \p Cache.
+  ///
+  /// \p Seed identifies everything that influences the formatting of a line
+  /// but is not part of the line itself, e.g. the style.
+  void setCache(FormattingCache *Cache, uint64_t Seed) {
+    this->Cache = Cache;
+    CacheSeed = Seed;
+  }
 
   unsigned format(const SmallVectorImpl<AnnotatedLine *> &Lines, bool DryRun,
                   int AdditionalIndent = 0, bool FixBadIndentation = false) {
@@ -947,8 +962,90 @@ private:
     if (State.Line->Type == LT_ObjCMethodDecl)
       State.Stack.back().BreakBeforeParameter = true;
 
+    // Lines containing nested blocks are formatted by recursive searches,
+    // whose results are not part of the line's own decisions.
+    uint64_t Key = 0;
+    if (Cache && !hasChildren(Line)) {
+      Key = getCacheKey(Line, FirstIndent);
+      if (const FormattingCache::Entry *Entry = Cache->lookup(Key)) {
+        if (Entry->NewLines.size() + 1 == countTokens(Line)) {
+          for (unsigned i = 0, e = Entry->NewLines.size(); i != e; ++i)
+            Indenter->addTokenToState(State, Entry->NewLines[i], DryRun);
+          return Entry->Penalty;
+        }
+      }
+    }
+
     // Find best solution in solution space.
-    return analyzeSolutionSpace(State, DryRun);
+    if (!Key)
+      return analyzeSolutionSpace(State, DryRun);
+    std::vector<bool> Decisions;
+    unsigned Penalty = analyzeSolutionSpace(State, DryRun, &Decisions);
+    if (Decisions.size() + 1 == countTokens(Line))
+      Cache->insert(Key, Penalty, Decisions);
+    return Penalty;
+  }
+
+  static bool hasChildren(const AnnotatedLine &Line) {
+    for (const FormatToken *Tok = Line.First; Tok; Tok = Tok->Next)
+      if (!Tok->Children.empty())
+        return true;
+    return false;
+  }
+
+  static unsigned countTokens(const AnnotatedLine &Line) {
+    unsigned Count = 0;
+    for (const FormatToken *Tok = Line.First; Tok; Tok = Tok->Next)
+      ++Count;
+    return Count;
+  }
+
+  /// \brief Computes the key identifying the formatting of \p Line in the
+  /// \c FormattingCache.
+  ///
+  /// Besides the token texts, this covers the annotations the search depends
+  /// on, as these are partly derived from the surrounding lines.
+  uint64_t getCacheKey(const AnnotatedLine &Line, unsigned FirstIndent) const {
+    llvm::MD5 Hash;
+    auto AddInt = [&Hash](uint64_t Value) {
+      uint8_t Bytes[8];
+      for (unsigned i = 0; i != 8; ++i)
+        Bytes[i] = static_cast<uint8_t>(Value >> (8 * i));
+      Hash.update(Bytes);
+    };
+    AddInt(CacheSeed);
+    AddInt(FirstIndent);
+    AddInt(Line.Level);
+    AddInt(Line.InPPDirective);
+    AddInt(Line.Type);
+    AddInt(Line.MustBeDeclaration);
+    AddInt(Line.MightBeFunctionDecl);
+    for (const FormatToken *Tok = Line.First; Tok; Tok = Tok->Next) {
+      Hash.update(Tok->TokenText);
+      AddInt(Tok->TokenText.size());
+      AddInt(Tok->NewlinesBefore);
+      AddInt(Tok->MustBreakBefore);
+      AddInt(Tok->CanBreakBefore);
+      AddInt(Tok->Type);
+      AddInt(Tok->BlockKind);
+      AddInt(Tok->PackingKind);
+      AddInt(Tok->ParameterCount);
+      AddInt(Tok->SpacesRequiredBefore);
+      AddInt(Tok->SplitPenalty);
+      AddInt(Tok->BindingStrength);
+      AddInt(Tok->NestingLevel);
+      AddInt(Tok->OriginalColumn);
+      AddInt(Tok->LastLineColumnWidth);
+      AddInt(Tok->Decision);
+      AddInt(Tok->Finalized);
+    }
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    uint64_t Key = 0;
+    for (unsigned i = 0; i != 8; ++i)
+      Key |= static_cast<uint64_t>(Result[i]) << (8 * i);
+    // Zero means "not cached" in format().
+    return Key ? Key : 1;
   }
 
   /// \brief An edge in the solution space from \c Previous->State to \c State,
@@ -1056,9 +1153,53 @@ private:
     return Style.ColumnLimit - (InPPDirective ? 2 : 0);
   }
 
-  struct CompareLineStatePointers {
-    bool operator()(LineState *obj1, LineState *obj2) const {
-      return *obj1 < *obj2;
+  /// \brief Hashes and compares \c LineState pointers by the pointed-to
+  /// states, including their \c ParenState stacks if \p CompareStack is set.
+  template <bool CompareStack> struct LineStatePointerInfo {
+    static LineState *getEmptyKey() {
+      return llvm::DenseMapInfo<LineState *>::getEmptyKey();
+    }
+    static LineState *getTombstoneKey() {
+      return llvm::DenseMapInfo<LineState *>::getTombstoneKey();
+    }
+    static unsigned getHashValue(const LineState *State) {
+      return State->getHash(CompareStack);
+    }
+    static bool isEqual(const LineState *LHS, const LineState *RHS) {
+      if (LHS == RHS)
+        return true;
+      if (LHS == getEmptyKey() || LHS == getTombstoneKey() ||
+          RHS == getEmptyKey() || RHS == getTombstoneKey())
+        return false;
+      return LHS->isEquivalentTo(*RHS, CompareStack);
+    }
+  };
+
+  /// \brief The set of states examined while analyzing the solution space.
+  ///
+  /// As with \c LineState::operator<, two states that only differ in their
+  /// \c ParenState stacks are the same if either of them has
+  /// \c IgnoreStackForComparison set.
+  class SeenStates {
+    llvm::DenseSet<LineState *, LineStatePointerInfo<true> > Seen;
+    llvm::DenseSet<LineState *, LineStatePointerInfo<false> > SeenIgnoringStack;
+    llvm::DenseSet<LineState *, LineStatePointerInfo<false> > IgnoringStack;
+
+  public:
+    /// \brief Adds \p State to the set. Returns \c false if an equivalent
+    /// state was seen before.
+    bool insert(LineState *State) {
+      State->computeHashes();
+      if (State->IgnoreStackForComparison) {
+        if (!SeenIgnoringStack.insert(State).second)
+          return false;
+        IgnoringStack.insert(State);
+        return true;
+      }
+      if (IgnoringStack.count(State) || !Seen.insert(State).second)
+        return false;
+      SeenIgnoringStack.insert(State);
+      return true;
     }
   };
 
@@ -1069,9 +1210,24 @@ private:
   /// find the shortest path (the one with lowest penalty) from \p InitialState
   /// to a state where all tokens are placed. Returns the penalty.
   ///
-  /// If \p DryRun is \c false, directly applies the changes.
-  unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun = false) {
-    std::set<LineState *, CompareLineStatePointers> Seen;
+  /// If \p DryRun is \c false, directly applies the changes. If \p Decisions
+  /// is not null and a solution is found, stores whether each token after the
+  /// first one starts a new line in it.
+  unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun = false,
+                                std::vector<bool> *Decisions = nullptr) {
+    ++SearchDepth;
+    unsigned Penalty = searchSolutionSpace(InitialState, DryRun, Decisions);
+    // Nested blocks are formatted by searches started from within the search
+    // for the enclosing line, so only the outermost search can free the
+    // nodes.
+    if (--SearchDepth == 0)
+      Allocator.Reset();
+    return Penalty;
+  }
+
+  unsigned searchSolutionSpace(LineState &InitialState, bool DryRun,
+                               std::vector<bool> *Decisions) {
+    SeenStates Seen;
 
     // Increasing count of \c StateNode items we have created. This is used to
     // create a deterministic order independent of the container.
@@ -1101,7 +1257,7 @@ private:
       if (Count > 10000)
         Node->State.IgnoreStackForComparison = true;
 
-      if (!Seen.insert(&Node->State).second)
+      if (!Seen.insert(&Node->State))
         // State already examined with lower penalty.
         continue;
 
@@ -1122,6 +1278,12 @@ private:
     // Reconstruct the solution.
     if (!DryRun)
       reconstructPath(InitialState, Queue.top().second);
+    if (Decisions) {
+      for (StateNode *Node = Queue.top().second; Node->Previous;
+           Node = Node->Previous)
+        Decisions->push_back(Node->NewLine);
+      std::reverse(Decisions->begin(), Decisions->end());
+    }
 
     DEBUG(llvm::dbgs() << "Total number of analyzed states: " << Count << "\n");
     DEBUG(llvm::dbgs() << "---\n");
@@ -1256,6 +1418,12 @@ private:
 
   llvm::SpecificBumpPtrAllocator<StateNode> Allocator;
 
+  /// \brief The number of solution space searches in progress.
+  unsigned SearchDepth;
+
+  FormattingCache *Cache;
+  uint64_t CacheSeed;
+
   // Cache to store the penalty of formatting a vector of AnnotatedLines
   // starting from a specific additional offset. Improves performance if there
   // are many nested blocks.
@@ -1678,8 +1846,9 @@ static StringRef getLanguageName(FormatStyle::LanguageKind Language) {
 class Formatter : public UnwrappedLineConsumer {
 public:
   Formatter(const FormatStyle &Style, Lexer &Lex, SourceManager &SourceMgr,
-            const std::vector<CharSourceRange> &Ranges)
-      : Style(Style), Lex(Lex), SourceMgr(SourceMgr),
+            const std::vector<CharSourceRange> &Ranges,
+            FormattingCache *Cache)
+      : Style(Style), Lex(Lex), SourceMgr(SourceMgr), Cache(Cache),
         Whitespaces(SourceMgr, Style, inputUsesCRLF(Lex.getBuffer())),
         Ranges(Ranges.begin(), Ranges.end()), UnwrappedLines(1),
         Encoding(encoding::detectEncoding(Lex.getBuffer())) {
@@ -1740,11 +1909,29 @@ public:
     ContinuationIndenter Indenter(Style, SourceMgr, Whitespaces, Encoding,
                                   BinPackInconclusiveFunctions);
     UnwrappedLineFormatter Formatter(&Indenter, &Whitespaces, Style);
+    if (Cache)
+      Formatter.setCache(Cache, getCacheSeed());
     Formatter.format(AnnotatedLines, /*DryRun=*/false);
     return Whitespaces.generateReplacements();
   }
 
 private:
+  // Returns the part of the FormattingCache keys that depends on the style
+  // derived for the current file.
+  uint64_t getCacheSeed() const {
+    llvm::MD5 Hash;
+    Hash.update(configurationAsText(Style));
+    uint8_t Flags[] = { static_cast<uint8_t>(Encoding),
+                        static_cast<uint8_t>(BinPackInconclusiveFunctions) };
+    Hash.update(Flags);
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    uint64_t Seed = 0;
+    for (unsigned i = 0; i != 8; ++i)
+      Seed |= static_cast<uint64_t>(Result[i]) << (8 * i);
+    return Seed;
+  }
+
   // Determines which lines are affected by the SourceRanges given as input.
   // Returns \c true if at least one line between I and E or one of their
   // children is affected.
@@ -1949,6 +2136,7 @@ private:
   FormatStyle Style;
   Lexer &Lex;
   SourceManager &SourceMgr;
+  FormattingCache *Cache;
   WhitespaceManager Whitespaces;
   SmallVector<CharSourceRange, 8> Ranges;
   SmallVector<SmallVector<UnwrappedLine, 16>, 2> UnwrappedLines;
@@ -1961,19 +2149,20 @@ private:
 
 tooling::Replacements reformat(const FormatStyle &Style, Lexer &Lex,
                                SourceManager &SourceMgr,
-                               std::vector<CharSourceRange> Ranges) {
+                               std::vector<CharSourceRange> Ranges,
+                               FormattingCache *Cache) {
   if (Style.DisableFormat) {
     tooling::Replacements EmptyResult;
     return EmptyResult;
   }
 
-  Formatter formatter(Style, Lex, SourceMgr, Ranges);
+  Formatter formatter(Style, Lex, SourceMgr, Ranges, Cache);
   return formatter.format();
 }
 
 tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                std::vector<tooling::Range> Ranges,
-                               StringRef FileName) {
+                               StringRef FileName, FormattingCache *Cache) {
   FileManager Files((FileSystemOptions()));
   DiagnosticsEngine Diagnostics(
       IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
@@ -1994,7 +2183,95 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
     SourceLocation End = Start.getLocWithOffset(Ranges[i].getLength());
     CharRanges.push_back(CharSourceRange::getCharRange(Start, End));
   }
-  return reformat(Style, Lex, SourceMgr, CharRanges);
+  return reformat(Style, Lex, SourceMgr, CharRanges, Cache);
+}
+
+static const char FormattingCacheHeader[] = "clang-format-cache 1";
+
+bool FormattingCache::load(StringRef FileName) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(FileName);
+  if (!Buffer)
+    return false;
+  SmallVector<StringRef, 0> Lines;
+  (*Buffer)->getBuffer().split(Lines, "\n", /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  if (Lines.empty() || Lines[0].rtrim() != FormattingCacheHeader)
+    return false;
+  llvm::MutexGuard Guard(Lock);
+  for (unsigned i = 1, e = Lines.size(); i != e; ++i) {
+    SmallVector<StringRef, 3> Fields;
+    Lines[i].rtrim().split(Fields, " ");
+    uint64_t Key;
+    Entry E;
+    if (Fields.size() < 2 || Fields[0].getAsInteger(10, Key) ||
+        Fields[1].getAsInteger(10, E.Penalty))
+      return false;
+    if (Fields.size() > 2) {
+      for (char C : Fields[2]) {
+        if (C != '0' && C != '1')
+          return false;
+        E.NewLines.push_back(C == '1');
+      }
+    }
+    E.Used = false;
+    Entries[Key] = E;
+  }
+  return true;
+}
+
+bool FormattingCache::save(StringRef FileName, unsigned MaxEntries) const {
+  std::string ErrorInfo;
+  llvm::raw_fd_ostream OS(FileName.str().c_str(), ErrorInfo,
+                          llvm::sys::fs::F_Text);
+  if (!ErrorInfo.empty())
+    return false;
+  OS << FormattingCacheHeader << "\n";
+  llvm::MutexGuard Guard(Lock);
+  // Entries of lines formatted in this run are written first, so that stale
+  // entries are the ones dropped when the cache is full.
+  unsigned Written = 0;
+  for (unsigned Pass = 0; Pass != 2; ++Pass) {
+    for (const auto &KeyAndEntry : Entries) {
+      const Entry &E = KeyAndEntry.second;
+      if (E.Used != (Pass == 0))
+        continue;
+      if (Written++ == MaxEntries)
+        return !OS.has_error();
+      OS << KeyAndEntry.first << " " << E.Penalty << " ";
+      for (bool NewLine : E.NewLines)
+        OS << (NewLine ? '1' : '0');
+      OS << "\n";
+    }
+  }
+  return !OS.has_error();
+}
+
+const FormattingCache::Entry *FormattingCache::lookup(uint64_t Key) {
+  llvm::MutexGuard Guard(Lock);
+  std::map<uint64_t, Entry>::iterator I = Entries.find(Key);
+  if (I == Entries.end())
+    return nullptr;
+  I->second.Used = true;
+  return &I->second;
+}
+
+void FormattingCache::insert(uint64_t Key, unsigned Penalty,
+                             const std::vector<bool> &NewLines) {
+  llvm::MutexGuard Guard(Lock);
+  std::pair<std::map<uint64_t, Entry>::iterator, bool> Inserted =
+      Entries.insert(std::make_pair(Key, Entry()));
+  Entry &E = Inserted.first->second;
+  if (Inserted.second) {
+    E.Penalty = Penalty;
+    E.NewLines = NewLines;
+  }
+  E.Used = true;
+}
+
+unsigned FormattingCache::size() const {
+  llvm::MutexGuard Guard(Lock);
+  return Entries.size();
 }
 
 LangOptions getFormattingLangOpts(FormatStyle::LanguageStandard Standard) {
@@ -2032,28 +2309,28 @@ static FormatStyle::LanguageKind getLanguageByFileName(StringRef FileName) {
 }
 
 FormatStyle getStyle(StringRef StyleName, StringRef FileName,
-                     StringRef FallbackStyle) {
+                     StringRef FallbackStyle, raw_ostream &Errs) {
   FormatStyle Style = getLLVMStyle();
   Style.Language = getLanguageByFileName(FileName);
   if (!getPredefinedStyle(FallbackStyle, Style.Language, &Style)) {
-    llvm::errs() << "Invalid fallback style \"" << FallbackStyle
-                 << "\" using LLVM style\n";
+    Errs << "Invalid fallback style \"" << FallbackStyle
+         << "\" using LLVM style\n";
     return Style;
   }
 
   if (StyleName.startswith("{")) {
     // Parse YAML/JSON style from the command line.
     if (std::error_code ec = parseConfiguration(StyleName, &Style)) {
-      llvm::errs() << "Error parsing -style: " << ec.message() << ", using "
-                   << FallbackStyle << " style\n";
+      Errs << "Error parsing -style: " << ec.message() << ", using "
+           << FallbackStyle << " style\n";
     }
     return Style;
   }
 
   if (!StyleName.equals_lower("file")) {
     if (!getPredefinedStyle(StyleName, Style.Language, &Style))
-      llvm::errs() << "Invalid value for -style, using " << FallbackStyle
-                   << " style\n";
+      Errs << "Invalid value for -style, using " << FallbackStyle
+           << " style\n";
     return Style;
   }
 
@@ -2086,7 +2363,7 @@ FormatStyle getStyle(StringRef StyleName, StringRef FileName,
       llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Text =
           llvm::MemoryBuffer::getFile(ConfigFile.c_str());
       if (std::error_code EC = Text.getError()) {
-        llvm::errs() << EC.message() << "\n";
+        Errs << EC.message() << "\n";
         break;
       }
       if (std::error_code ec =
@@ -2097,23 +2374,27 @@ FormatStyle getStyle(StringRef StyleName, StringRef FileName,
           UnsuitableConfigFiles.append(ConfigFile);
           continue;
         }
-        llvm::errs() << "Error reading " << ConfigFile << ": " << ec.message()
-                     << "\n";
+        Errs << "Error reading " << ConfigFile << ": " << ec.message() << "\n";
         break;
       }
       DEBUG(llvm::dbgs() << "Using configuration file " << ConfigFile << "\n");
       return Style;
     }
   }
-  llvm::errs() << "Can't find usable .clang-format, using " << FallbackStyle
-               << " style\n";
+  Errs << "Can't find usable .clang-format, using " << FallbackStyle
+       << " style\n";
   if (!UnsuitableConfigFiles.empty()) {
-    llvm::errs() << "Configuration file(s) do(es) not support "
-                 << getLanguageName(Style.Language) << ": "
-                 << UnsuitableConfigFiles << "\n";
+    Errs << "Configuration file(s) do(es) not support "
+         << getLanguageName(Style.Language) << ": " << UnsuitableConfigFiles
+         << "\n";
   }
   return Style;
 }
 
+FormatStyle getStyle(StringRef StyleName, StringRef FileName,
+                     StringRef FallbackStyle) {
+  return getStyle(StyleName, FileName, FallbackStyle, llvm::errs());
+}
+
 } // namespace format
 } // namespace clang
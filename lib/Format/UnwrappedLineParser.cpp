@@ -53,6 +53,14 @@ private:
   std::vector<bool> &Stack;
 };
 
+// The token returned at the end of a preprocessor directive.
+struct FakeEOFToken : public FormatToken {
+  FakeEOFToken() {
+    Tok.startToken();
+    Tok.setKind(tok::eof);
+  }
+};
+
 class ScopedMacroState : public FormatTokenSource {
 public:
   ScopedMacroState(UnwrappedLine &Line, FormatTokenSource *&TokenSource,
@@ -95,13 +103,9 @@ private:
   bool eof() { return Token && Token->HasUnescapedNewline; }
 
   FormatToken *getFakeEOF() {
-    static bool EOFInitialized = false;
-    static FormatToken FormatTok;
-    if (!EOFInitialized) {
-      FormatTok.Tok.startToken();
-      FormatTok.Tok.setKind(tok::eof);
-      EOFInitialized = true;
-    }
+    // Files may be formatted concurrently; the token is fully set up by the
+    // initialization of the static, which only ever runs once.
+    static FakeEOFToken FormatTok;
     return &FormatTok;
   }
 
@@ -79,10 +79,47 @@ namespace {
     }
   };
   
+  /// \brief A precompiled preamble shared by all of the ASTUnits whose main
+  /// files start with the same preamble and are parsed with the same options.
+  ///
+  /// Everything but the reference count is immutable once the preamble has
+  /// been registered, and the reference count is guarded by the on-disk mutex.
+  struct SharedPreamble {
+    /// \brief The key under which this preamble is registered.
+    std::string Key;
+
+    /// \brief The main file the preamble was built from.
+    std::string MainFilename;
+
+    /// \brief The file in which the precompiled preamble is stored.
+    std::string PreambleFile;
+
+    /// \brief The preamble text that was precompiled.
+    std::vector<char> Contents;
+    bool EndsAtStartOfLine;
+
+    /// \brief The files used by the preamble; see ASTUnit::FilesInPreamble.
+    llvm::StringMap<ASTUnit::PreambleFileHash> FilesInPreamble;
+
+    SmallVector<ASTUnit::StandaloneDiagnostic, 4> Diagnostics;
+    unsigned NumWarnings;
+    std::vector<serialization::DeclID> TopLevelDecls;
+    unsigned TopLevelHashValue;
+
+    /// \brief The number of ASTUnits using this preamble.
+    unsigned RefCount;
+  };
+
   struct OnDiskData {
     /// \brief The file in which the precompiled preamble is stored.
     std::string PreambleFile;
 
+    /// \brief The shared preamble stored in \c PreambleFile, if any. The
+    /// file is only erased once the last ASTUnit using it lets it go.
+    SharedPreamble *Shared;
+
+    OnDiskData() : Shared(nullptr) { }
+
     /// \brief Temporary files that should be removed when the ASTUnit is
     /// destroyed.
     SmallVector<std::string, 4> TemporaryFiles;
@@ -156,7 +193,69 @@ static void removeOnDiskEntry(const ASTUnit *AU) {
 }
 
 static void setPreambleFile(const ASTUnit *AU, StringRef preambleFile) {
-  getOnDiskData(AU).PreambleFile = preambleFile;
+  OnDiskData &D = getOnDiskData(AU);
+  if (D.Shared)
+    D.CleanPreambleFile();
+  D.PreambleFile = preambleFile;
+}
+
+typedef llvm::StringMap<SharedPreamble *> SharedPreambleMap;
+static SharedPreambleMap &getSharedPreambleMap() {
+  // Never destroyed: the map is still used when cleaning up at exit.
+  static SharedPreambleMap *M = new SharedPreambleMap();
+  return *M;
+}
+
+/// \brief Find the shared preamble registered under \p Key and take a
+/// reference to it, or return null.
+static SharedPreamble *acquireSharedPreamble(StringRef Key) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  SharedPreambleMap::iterator I = getSharedPreambleMap().find(Key);
+  if (I == getSharedPreambleMap().end())
+    return nullptr;
+
+  SharedPreamble *SP = I->second;
+  ++SP->RefCount;
+  return SP;
+}
+
+/// \brief Drop a reference to \p SP, erasing its preamble file if this was
+/// the last one.
+static void releaseSharedPreamble(SharedPreamble *SP) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  if (--SP->RefCount)
+    return;
+
+  SharedPreambleMap &M = getSharedPreambleMap();
+  SharedPreambleMap::iterator I = M.find(SP->Key);
+  if (I != M.end() && I->second == SP)
+    M.erase(I);
+  llvm::sys::fs::remove(SP->PreambleFile);
+  delete SP;
+}
+
+/// \brief Make \p SP the preamble of \p AU, which must already hold a
+/// reference to it.
+static void setSharedPreamble(const ASTUnit *AU, SharedPreamble *SP) {
+  OnDiskData &D = getOnDiskData(AU);
+  D.CleanPreambleFile();
+  D.PreambleFile = SP->PreambleFile;
+  D.Shared = SP;
+}
+
+/// \brief Register the preamble file owned by \p AU so that other ASTUnits
+/// can reuse it. \p SP is the description of the preamble, which the map
+/// takes ownership of.
+static void registerSharedPreamble(const ASTUnit *AU, SharedPreamble *SP) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  OnDiskData &D = getOnDiskData(AU);
+  SP->PreambleFile = D.PreambleFile;
+  SP->RefCount = 1;
+  D.Shared = SP;
+
+  // A preamble registered under the same key is left to its current users;
+  // new lookups will find this one.
+  getSharedPreambleMap()[SP->Key] = SP;
 }
 
 static const std::string &getPreambleFile(const ASTUnit *AU) {
@@ -170,7 +269,11 @@ void OnDiskData::CleanTemporaryFiles() {
 }
 
 void OnDiskData::CleanPreambleFile() {
-  if (!PreambleFile.empty()) {
+  if (Shared) {
+    releaseSharedPreamble(Shared);
+    Shared = nullptr;
+    PreambleFile.clear();
+  } else if (!PreambleFile.empty()) {
     llvm::sys::fs::remove(PreambleFile);
     PreambleFile.clear();
   }
@@ -1026,6 +1129,41 @@ static void checkAndSanitizeDiags(SmallVectorImpl<StoredDiagnostic> &
   }
 }
 
+/// \brief Record the files that \p SourceMgr has loaded, as seen by a parse
+/// that used the files remapped by \p PreprocessorOpts.
+static void recordFilesInParse(
+    const SourceManager &SourceMgr, FileManager &FileMgr,
+    const PreprocessorOptions &PreprocessorOpts,
+    llvm::StringMap<ASTUnit::PreambleFileHash> &Files) {
+  for (SourceManager::fileinfo_iterator I = SourceMgr.fileinfo_begin(),
+                                        E = SourceMgr.fileinfo_end();
+       I != E; ++I) {
+    const FileEntry *File = I->first;
+    llvm::MemoryBuffer *Buffer = I->second->getRawBuffer();
+    if (time_t ModTime = File->getModificationTime())
+      Files[File->getName()] =
+          Buffer ? ASTUnit::PreambleFileHash::createForFileContents(
+                       File->getSize(), ModTime, Buffer)
+                 : ASTUnit::PreambleFileHash::createForFile(File->getSize(),
+                                                            ModTime);
+    else if (Buffer)
+      Files[File->getName()] =
+          ASTUnit::PreambleFileHash::createForMemoryBuffer(Buffer);
+  }
+
+  // Remapped files are compared by their contents, not by the file they
+  // replace.
+  for (const auto &R : PreprocessorOpts.RemappedFiles) {
+    vfs::Status Status;
+    if (!FileMgr.getNoncachedStatValue(R.second, Status))
+      Files[R.first] = ASTUnit::PreambleFileHash::createForFile(
+          Status.getSize(), Status.getLastModificationTime().toEpochTime());
+  }
+  for (const auto &RB : PreprocessorOpts.RemappedFileBuffers)
+    Files[RB.first] =
+        ASTUnit::PreambleFileHash::createForMemoryBuffer(RB.second);
+}
+
 /// Parse the source file into a translation unit using the given compiler
 /// invocation, replacing the current translation unit.
 ///
@@ -1034,6 +1172,7 @@ static void checkAndSanitizeDiags(SmallVectorImpl<StoredDiagnostic> &
 bool ASTUnit::Parse(llvm::MemoryBuffer *OverrideMainBuffer) {
   delete SavedMainFileBuffer;
   SavedMainFileBuffer = nullptr;
+  FilesInLastParse.clear();
 
   if (!Invocation) {
     delete OverrideMainBuffer;
@@ -1158,6 +1297,12 @@ bool ASTUnit::Parse(llvm::MemoryBuffer *OverrideMainBuffer) {
 
   FailedParseDiagnostics.clear();
 
+  if (!getDiagnostics().hasErrorOccurred()) {
+    FilesInLastParse = FilesInPreamble;
+    recordFilesInParse(getSourceManager(), getFileManager(),
+                       Invocation->getPreprocessorOpts(), FilesInLastParse);
+  }
+
   return false;
 
 error:
@@ -1176,13 +1321,24 @@ error:
   return true;
 }
 
+/// \brief Check whether the preamble of any ASTUnit is stored in \p Path.
+static bool isPreambleFileInUse(StringRef Path) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  OnDiskDataMap &M = getOnDiskDataMap();
+  for (OnDiskDataMap::iterator I = M.begin(), E = M.end(); I != E; ++I)
+    if (I->second->PreambleFile == Path)
+      return true;
+  return false;
+}
+
 /// \brief Simple function to retrieve a path for a preamble precompiled header.
 static std::string GetPreamblePCHPath() {
   // FIXME: This is a hack so that we can override the preamble file during
   // crash-recovery testing, which is the only case where the preamble files
-  // are not necessarily cleaned up.
+  // are not necessarily cleaned up. The file may be shared by several
+  // ASTUnits, so it is not overwritten while any of them still uses it.
   const char *TmpFile = ::getenv("CINDEXTEST_PREAMBLE_FILE");
-  if (TmpFile)
+  if (TmpFile && !isPreambleFileInUse(TmpFile))
     return TmpFile;
 
   SmallString<128> Path;
@@ -1283,6 +1439,21 @@ ASTUnit::PreambleFileHash ASTUnit::PreambleFileHash::createForMemoryBuffer(
   return Result;
 }
 
+ASTUnit::PreambleFileHash ASTUnit::PreambleFileHash::createForFileContents(
+    off_t Size, time_t ModTime, const llvm::MemoryBuffer *Buffer) {
+  PreambleFileHash Result = createForMemoryBuffer(Buffer);
+  Result.Size = Size;
+  Result.ModTime = ModTime;
+  return Result;
+}
+
+bool ASTUnit::PreambleFileHash::hasMD5() const {
+  for (unsigned I = 0; I != sizeof(MD5); ++I)
+    if (MD5[I])
+      return true;
+  return false;
+}
+
 namespace clang {
 bool operator==(const ASTUnit::PreambleFileHash &LHS,
                 const ASTUnit::PreambleFileHash &RHS) {
@@ -1338,6 +1509,176 @@ static void makeStandaloneDiagnostic(const LangOptions &LangOpts,
   }
 }
 
+/// \brief Determine whether any of the files used by a precompiled preamble
+/// has changed since the preamble was built, either on disk or through the
+/// files remapped by \p PreprocessorOpts.
+static bool havePreambleFilesChanged(
+    FileManager &FileMgr, const PreprocessorOptions &PreprocessorOpts,
+    const llvm::StringMap<ASTUnit::PreambleFileHash> &FilesInPreamble) {
+  // First, make a record of those files that have been overridden via
+  // remapping or unsaved_files.
+  llvm::StringMap<ASTUnit::PreambleFileHash> OverriddenFiles;
+  for (const auto &R : PreprocessorOpts.RemappedFiles) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(R.second, Status)) {
+      // If we can't stat the file we're remapping to, assume that something
+      // horrible happened.
+      return true;
+    }
+
+    OverriddenFiles[R.first] = ASTUnit::PreambleFileHash::createForFile(
+        Status.getSize(), Status.getLastModificationTime().toEpochTime());
+  }
+
+  for (const auto &RB : PreprocessorOpts.RemappedFileBuffers)
+    OverriddenFiles[RB.first] =
+        ASTUnit::PreambleFileHash::createForMemoryBuffer(RB.second);
+
+  // Check whether anything has changed.
+  for (llvm::StringMap<ASTUnit::PreambleFileHash>::const_iterator
+         F = FilesInPreamble.begin(), FEnd = FilesInPreamble.end();
+       F != FEnd; ++F) {
+    llvm::StringMap<ASTUnit::PreambleFileHash>::iterator Overridden
+      = OverriddenFiles.find(F->first());
+    if (Overridden != OverriddenFiles.end()) {
+      // This file was remapped; check whether the newly-mapped file
+      // matches up with the previous mapping.
+      if (Overridden->second != F->second)
+        return true;
+      continue;
+    }
+
+    // The file was not remapped; check whether it has changed on disk.
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(F->first(), Status)) {
+      // If we can't stat the file, assume that something horrible happened.
+      return true;
+    }
+    if (Status.getSize() != uint64_t(F->second.Size) ||
+        Status.getLastModificationTime().toEpochTime() !=
+            uint64_t(F->second.ModTime))
+      return true;
+  }
+
+  return false;
+}
+
+/// \brief Returns true if the contents of one of the on-disk \p Files whose
+/// MD5 is known, and that \p PreprocessorOpts doesn't remap, have changed.
+static bool haveFileContentsChanged(
+    FileManager &FileMgr, const PreprocessorOptions &PreprocessorOpts,
+    const llvm::StringMap<ASTUnit::PreambleFileHash> &Files) {
+  llvm::StringSet<> Remapped;
+  for (const auto &R : PreprocessorOpts.RemappedFiles)
+    Remapped.insert(R.first);
+  for (const auto &RB : PreprocessorOpts.RemappedFileBuffers)
+    Remapped.insert(RB.first);
+
+  for (llvm::StringMap<ASTUnit::PreambleFileHash>::const_iterator
+         F = Files.begin(), FEnd = Files.end();
+       F != FEnd; ++F) {
+    if (!F->second.ModTime || !F->second.hasMD5() ||
+        Remapped.count(F->first()))
+      continue;
+    std::unique_ptr<llvm::MemoryBuffer> Buffer(
+        FileMgr.getBufferForFile(F->first()));
+    if (!Buffer)
+      return true;
+    ASTUnit::PreambleFileHash Hash =
+        ASTUnit::PreambleFileHash::createForMemoryBuffer(Buffer.get());
+    if (memcmp(Hash.MD5, F->second.MD5, sizeof(Hash.MD5)) != 0)
+      return true;
+  }
+  return false;
+}
+
+/// \brief Append \p Str to the shared preamble key \p OS, prefixed by its
+/// length so that no two sequences of strings produce the same key.
+static void addToSharedPreambleKey(raw_ostream &OS, StringRef Str) {
+  OS << Str.size() << ':' << Str;
+}
+
+/// \brief Compute the key under which the precompiled preamble \p Preamble
+/// of the main file of \p Invocation is shared between ASTUnits.
+///
+/// Any main file that starts with the same preamble text can share it, as
+/// long as it is in the same directory: quoted includes are looked up
+/// relative to the main file. Beyond that, the key spells out all of the
+/// options that affect what the preamble contains and which diagnostics it
+/// produces, so two preambles only share a key if they are interchangeable.
+///
+/// FIXME: A header in the preamble that expands __BASE_FILE__ sees the main
+/// file the preamble was built for.
+static std::string getSharedPreambleKey(const CompilerInvocation &Invocation,
+                                        StringRef MainFilename,
+                                        StringRef Preamble,
+                                        bool EndsAtStartOfLine) {
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  addToSharedPreambleKey(OS, Preamble);
+  OS << EndsAtStartOfLine;
+  addToSharedPreambleKey(OS, llvm::sys::path::parent_path(MainFilename));
+  addToSharedPreambleKey(OS, Invocation.getFileSystemOpts().WorkingDir);
+
+  const LangOptions &LangOpts = *Invocation.getLangOpts();
+#define LANGOPT(Name, Bits, Default, Description) \
+  OS << LangOpts.Name << ',';
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description) \
+  OS << static_cast<unsigned>(LangOpts.get##Name()) << ',';
+#include "clang/Basic/LangOptions.def"
+  for (const auto &Name : LangOpts.CommentOpts.BlockCommandNames)
+    addToSharedPreambleKey(OS, Name);
+  OS << LangOpts.CommentOpts.ParseAllComments << ';';
+
+  const TargetOptions &TargetOpts = Invocation.getTargetOpts();
+  addToSharedPreambleKey(OS, TargetOpts.Triple);
+  addToSharedPreambleKey(OS, TargetOpts.CPU);
+  addToSharedPreambleKey(OS, TargetOpts.ABI);
+  for (const auto &Feature : TargetOpts.FeaturesAsWritten)
+    addToSharedPreambleKey(OS, Feature);
+  OS << ';';
+
+  const HeaderSearchOptions &HSOpts = Invocation.getHeaderSearchOpts();
+  addToSharedPreambleKey(OS, HSOpts.Sysroot);
+  addToSharedPreambleKey(OS, HSOpts.ResourceDir);
+  addToSharedPreambleKey(OS, HSOpts.ModuleCachePath);
+  addToSharedPreambleKey(OS, HSOpts.ModuleUserBuildPath);
+  OS << HSOpts.UseBuiltinIncludes << HSOpts.UseStandardSystemIncludes
+     << HSOpts.UseStandardCXXIncludes << HSOpts.UseLibcxx;
+  for (const auto &E : HSOpts.UserEntries) {
+    addToSharedPreambleKey(OS, E.Path);
+    OS << static_cast<unsigned>(E.Group) << E.IsFramework << E.IgnoreSysRoot;
+  }
+  OS << ';';
+
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  for (const auto &Macro : PPOpts.Macros) {
+    addToSharedPreambleKey(OS, Macro.first);
+    OS << Macro.second;
+  }
+  OS << ';';
+  for (const auto &Include : PPOpts.Includes)
+    addToSharedPreambleKey(OS, Include);
+  OS << ';';
+  for (const auto &Include : PPOpts.MacroIncludes)
+    addToSharedPreambleKey(OS, Include);
+  OS << ';';
+  addToSharedPreambleKey(OS, PPOpts.ImplicitPCHInclude);
+  addToSharedPreambleKey(OS, PPOpts.ImplicitPTHInclude);
+  OS << PPOpts.UsePredefines << PPOpts.DetailedRecord
+     << PPOpts.AllowPCHWithCompilerErrors << PPOpts.DisablePCHValidation;
+
+  // Skipped function bodies are stored in the preamble.
+  OS << Invocation.getFrontendOpts().SkipFunctionBodies << ';';
+
+  const DiagnosticOptions &DiagOpts = Invocation.getDiagnosticOpts();
+  OS << DiagOpts.IgnoreWarnings << DiagOpts.Pedantic << DiagOpts.PedanticErrors;
+  for (const auto &Warning : DiagOpts.Warnings)
+    addToSharedPreambleKey(OS, Warning);
+
+  return OS.str();
+}
+
 /// \brief Attempt to build or re-use a precompiled preamble when (re-)parsing
 /// the source file.
 ///
@@ -1402,60 +1743,9 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
       // preamble.
 
       // Check that none of the files used by the preamble have changed.
-      bool AnyFileChanged = false;
-          
-      // First, make a record of those files that have been overridden via
-      // remapping or unsaved_files.
-      llvm::StringMap<PreambleFileHash> OverriddenFiles;
-      for (const auto &R : PreprocessorOpts.RemappedFiles) {
-        if (AnyFileChanged)
-          break;
-
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(R.second, Status)) {
-          // If we can't stat the file we're remapping to, assume that something
-          // horrible happened.
-          AnyFileChanged = true;
-          break;
-        }
-
-        OverriddenFiles[R.first] = PreambleFileHash::createForFile(
-            Status.getSize(), Status.getLastModificationTime().toEpochTime());
-      }
+      bool AnyFileChanged =
+          havePreambleFilesChanged(*FileMgr, PreprocessorOpts, FilesInPreamble);
 
-      for (const auto &RB : PreprocessorOpts.RemappedFileBuffers) {
-        if (AnyFileChanged)
-          break;
-        OverriddenFiles[RB.first] =
-            PreambleFileHash::createForMemoryBuffer(RB.second);
-      }
-       
-      // Check whether anything has changed.
-      for (llvm::StringMap<PreambleFileHash>::iterator 
-             F = FilesInPreamble.begin(), FEnd = FilesInPreamble.end();
-           !AnyFileChanged && F != FEnd; 
-           ++F) {
-        llvm::StringMap<PreambleFileHash>::iterator Overridden
-          = OverriddenFiles.find(F->first());
-        if (Overridden != OverriddenFiles.end()) {
-          // This file was remapped; check whether the newly-mapped file 
-          // matches up with the previous mapping.
-          if (Overridden->second != F->second)
-            AnyFileChanged = true;
-          continue;
-        }
-        
-        // The file was not remapped; check whether it has changed on disk.
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(F->first(), Status)) {
-          // If we can't stat the file, assume that something horrible happened.
-          AnyFileChanged = true;
-        } else if (Status.getSize() != uint64_t(F->second.Size) ||
-                   Status.getLastModificationTime().toEpochTime() !=
-                       uint64_t(F->second.ModTime))
-          AnyFileChanged = true;
-      }
-          
       if (!AnyFileChanged) {
         // Okay! We can re-use the precompiled preamble.
 
@@ -1495,6 +1785,57 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
     return nullptr;
   }
 
+  StringRef MainFilename = FrontendOpts.Inputs[0].getFile();
+  StringRef NewPreambleText =
+      NewPreamble.first->getBuffer().slice(0, NewPreamble.second.first);
+
+  // Another ASTUnit may already have precompiled this very preamble, maybe
+  // for another main file; if none of the files it depends on has changed
+  // since, share it.
+  std::string SharedKey =
+      getSharedPreambleKey(*PreambleInvocation, MainFilename, NewPreambleText,
+                           NewPreamble.second.second);
+  if (SharedPreamble *SP = acquireSharedPreamble(SharedKey)) {
+    if (havePreambleFilesChanged(*FileMgr, PreprocessorOpts,
+                                 SP->FilesInPreamble)) {
+      releaseSharedPreamble(SP);
+    } else {
+      setSharedPreamble(this, SP);
+      Preamble.assign(FileMgr->getFile(MainFilename),
+                      SP->Contents.data(),
+                      SP->Contents.data() + SP->Contents.size());
+      PreambleEndsAtStartOfLine = SP->EndsAtStartOfLine;
+      FilesInPreamble = SP->FilesInPreamble;
+      NumWarningsInPreamble = SP->NumWarnings;
+      TopLevelDeclsInPreamble = SP->TopLevelDecls;
+      OriginalSourceFile = MainFilename;
+      TopLevelDecls.clear();
+      PreambleRebuildCounter = 1;
+
+      // Diagnostics in the preamble text belong to this main file.
+      PreambleDiagnostics = SP->Diagnostics;
+      for (unsigned I = 0, N = PreambleDiagnostics.size(); I != N; ++I)
+        if (PreambleDiagnostics[I].Filename == SP->MainFilename)
+          PreambleDiagnostics[I].Filename = MainFilename;
+
+      // The completion cache was built against a different preamble.
+      CurrentTopLevelHashValue = SP->TopLevelHashValue;
+      PreambleTopLevelHashValue = SP->TopLevelHashValue;
+      CompletionCacheTopLevelHashValue = 0;
+
+      // Set the state of the diagnostic object to mimic its state
+      // after parsing the preamble.
+      getDiagnostics().Reset();
+      ProcessWarningOptions(getDiagnostics(),
+                            PreambleInvocation->getDiagnosticOpts());
+      checkAndRemoveNonDriverDiags(StoredDiagnostics);
+      getDiagnostics().setNumWarnings(NumWarningsInPreamble);
+
+      return llvm::MemoryBuffer::getMemBufferCopy(
+          NewPreamble.first->getBuffer(), MainFilename);
+    }
+  }
+
   // Create a temporary file for the precompiled preamble. In rare 
   // circumstances, this can fail.
   std::string PreamblePCHPath = GetPreamblePCHPath();
@@ -1510,7 +1851,6 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
 
   // Save the preamble text for later; we'll need to compare against it for
   // subsequent reparses.
-  StringRef MainFilename = FrontendOpts.Inputs[0].getFile();
   Preamble.assign(FileMgr->getFile(MainFilename),
                   NewPreamble.first->getBufferStart(), 
                   NewPreamble.first->getBufferStart() 
@@ -1663,6 +2003,20 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
     CompletionCacheTopLevelHashValue = 0;
     PreambleTopLevelHashValue = CurrentTopLevelHashValue;
   }
+
+  // Let other ASTUnits whose main files start with this preamble reuse it.
+  SharedPreamble *SP = new SharedPreamble();
+  SP->Key = SharedKey;
+  SP->MainFilename = MainFilename;
+  SP->Contents.assign(Preamble.getBufferStart(),
+                      Preamble.getBufferStart() + Preamble.size());
+  SP->EndsAtStartOfLine = PreambleEndsAtStartOfLine;
+  SP->FilesInPreamble = FilesInPreamble;
+  SP->Diagnostics = PreambleDiagnostics;
+  SP->NumWarnings = NumWarningsInPreamble;
+  SP->TopLevelDecls = TopLevelDeclsInPreamble;
+  SP->TopLevelHashValue = CurrentTopLevelHashValue;
+  registerSharedPreamble(this, SP);
   
   return llvm::MemoryBuffer::getMemBufferCopy(NewPreamble.first->getBuffer(),
                                               MainFilename);
@@ -2044,6 +2398,24 @@ bool ASTUnit::Reparse(ArrayRef<RemappedFile> RemappedFiles) {
   if (!Invocation)
     return true;
 
+  // If none of the files used by the last parse have changed, and we are not
+  // waiting to build a precompiled preamble, the AST is still up to date.
+  // Keep it, along with the buffers it refers to.
+  if (!FilesInLastParse.empty() &&
+      (PreambleRebuildCounter == 0 || !getPreambleFile(this).empty())) {
+    PreprocessorOptions NewPPOpts;
+    for (const auto &RF : RemappedFiles)
+      NewPPOpts.addRemappedFile(RF.first, RF.second);
+    if (!havePreambleFilesChanged(getFileManager(), NewPPOpts,
+                                  FilesInLastParse) &&
+        !haveFileContentsChanged(getFileManager(), NewPPOpts,
+                                 FilesInLastParse)) {
+      for (const auto &RF : RemappedFiles)
+        delete RF.second;
+      return false;
+    }
+  }
+
   clearFileLevelDecls();
   
   SimpleTimer ParsingTimer(WantTiming);
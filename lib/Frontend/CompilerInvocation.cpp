@@ -282,6 +282,32 @@ static bool ParseAnalyzerArgs(AnalyzerOptions &Opts, ArgList &Args,
     }
   }
 
+  // A negative memory budget would wrap around to an almost unlimited one.
+  std::string MaxGraphMemoryValue = Opts.Config.lookup("max-graph-memory");
+  int MaxGraphMemory;
+  if (!MaxGraphMemoryValue.empty() &&
+      (StringRef(MaxGraphMemoryValue).getAsInteger(10, MaxGraphMemory) ||
+       MaxGraphMemory < 0)) {
+    Diags.Report(SourceLocation(), diag::err_analyzer_config_invalid_value)
+      << "max-graph-memory" << MaxGraphMemoryValue
+      << "a non-negative number of megabytes";
+    Success = false;
+  }
+
+  // The shard to analyze must be one of the shards.
+  std::string ShardIndexValue = Opts.Config.lookup("shard-index");
+  if (!ShardIndexValue.empty()) {
+    int NumShards = 1, ShardIndex;
+    StringRef(Opts.Config.lookup("shard-count")).getAsInteger(10, NumShards);
+    if (StringRef(ShardIndexValue).getAsInteger(10, ShardIndex) ||
+        ShardIndex < 0 || ShardIndex >= std::max(NumShards, 1)) {
+      Diags.Report(SourceLocation(), diag::err_analyzer_config_invalid_value)
+        << "shard-index" << ShardIndexValue
+        << "an index less than 'shard-count'";
+      Success = false;
+    }
+  }
+
   return Success;
 }
 
@@ -1464,6 +1490,7 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       getLastArgIntValue(Args, OPT_fconstexpr_steps, 1048576, Diags);
   Opts.BracketDepth = getLastArgIntValue(Args, OPT_fbracket_depth, 256, Diags);
   Opts.DelayedTemplateParsing = Args.hasArg(OPT_fdelayed_template_parsing);
+  Opts.PCHInstantiateTemplates = Args.hasArg(OPT_fpch_instantiate_templates);
   Opts.NumLargeByValueCopy =
       getLastArgIntValue(Args, OPT_Wlarge_by_value_copy_EQ, 0, Diags);
   Opts.MSBitfields = Args.hasArg(OPT_mms_bitfields);
@@ -1862,7 +1862,8 @@ Decl *Parser::ParseFunctionStatementBody(Decl *Decl, ParseScope &BodyScope) {
   if (SkipFunctionBodies && (!Decl || Actions.canSkipFunctionBody(Decl)) &&
       trySkippingFunctionBody()) {
     BodyScope.Exit();
-    return Actions.ActOnSkippedFunctionBody(Decl);
+    return Actions.ActOnSkippedFunctionBody(
+        Decl, SourceRange(LBraceLoc, PrevTokLocation));
   }
 
   PrettyDeclStackTraceEntry CrashInfo(Actions, Decl, LBraceLoc,
@@ -1901,10 +1902,13 @@ Decl *Parser::ParseFunctionTryBlock(Decl *Decl, ParseScope &BodyScope) {
   else
     Actions.ActOnDefaultCtorInitializers(Decl);
 
-  if (SkipFunctionBodies && Actions.canSkipFunctionBody(Decl) &&
-      trySkippingFunctionBody()) {
-    BodyScope.Exit();
-    return Actions.ActOnSkippedFunctionBody(Decl);
+  if (SkipFunctionBodies && Actions.canSkipFunctionBody(Decl)) {
+    SourceLocation LBraceLoc = Tok.getLocation();
+    if (trySkippingFunctionBody()) {
+      BodyScope.Exit();
+      return Actions.ActOnSkippedFunctionBody(
+          Decl, SourceRange(LBraceLoc, PrevTokLocation));
+    }
   }
 
   SourceLocation LBraceLoc = Tok.getLocation();
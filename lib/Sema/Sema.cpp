@@ -103,6 +103,7 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
     CurrentInstantiationScope(nullptr), DisableTypoCorrection(false),
     TyposCorrected(0), AnalysisWarnings(*this),
+    NumPendingInstantiationsPerformed(0),
     VarDataSharingAttributesStack(nullptr), CurScope(nullptr),
     Ident_super(nullptr), Ident___float128(nullptr)
 {
@@ -297,6 +298,8 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumPendingInstantiationsPerformed
+               << " pending implicit instantiations processed.\n";
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
@@ -604,7 +607,7 @@ void Sema::ActOnEndOfTranslationUnit() {
     return;
 
   // Complete translation units and modules define vtables and perform implicit
-  // instantiations. PCH files do not.
+  // instantiations. PCH files do not, unless asked to instantiate templates.
   if (TUKind != TU_Prefix) {
     DiagnoseUseOfUnimplementedSelectors();
 
@@ -647,6 +650,19 @@ void Sema::ActOnEndOfTranslationUnit() {
     }
     PerformPendingInstantiations();
 
+    CheckDelayedMemberExceptionSpecs();
+  } else if (LangOpts.PCHInstantiateTemplates) {
+    // Instantiate the definitions the header requires now, so that they are
+    // stored in the PCH file and found to be defined in every translation
+    // unit using it, instead of being instantiated again in each of them.
+    // Their point of instantiation becomes the end of the header rather than
+    // the end of the translation unit, so this is not the default.
+    PerformPendingInstantiations();
+    PendingInstantiations.insert(PendingInstantiations.end(),
+                                 PendingInstantiationsAfterPrefix.begin(),
+                                 PendingInstantiationsAfterPrefix.end());
+    PendingInstantiationsAfterPrefix.clear();
+
     CheckDelayedMemberExceptionSpecs();
   }
 
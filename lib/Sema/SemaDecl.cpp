@@ -10072,10 +10072,13 @@ bool Sema::canSkipFunctionBody(Decl *D) {
   return Consumer.shouldSkipFunctionBody(D);
 }
 
-Decl *Sema::ActOnSkippedFunctionBody(Decl *Decl) {
-  if (FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(Decl))
+Decl *Sema::ActOnSkippedFunctionBody(Decl *Decl, SourceRange BodyRange) {
+  if (FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(Decl)) {
     FD->setHasSkippedBody();
-  else if (ObjCMethodDecl *MD = dyn_cast_or_null<ObjCMethodDecl>(Decl))
+    // Keep the skipped body within the extent of the function.
+    if (BodyRange.getEnd().isValid())
+      FD->setRangeEnd(BodyRange.getEnd());
+  } else if (ObjCMethodDecl *MD = dyn_cast_or_null<ObjCMethodDecl>(Decl))
     MD->setHasSkippedBody();
   return ActOnFinishFunctionBody(Decl, nullptr);
 }
@@ -3728,13 +3728,11 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
   // queue of pending implicit instantiations that we will instantiate later,
   // while we're still within our own instantiation context.
   SmallVector<VTableUse, 16> SavedVTableUses;
-  std::deque<PendingImplicitInstantiation> SavedPendingInstantiations;
+  SavePendingInstantiationsRAII SavedPendingInstantiations(*this, Recursive);
   SavePendingLocalImplicitInstantiationsRAII
       SavedPendingLocalImplicitInstantiations(*this);
-  if (Recursive) {
+  if (Recursive)
     VTableUses.swap(SavedVTableUses);
-    PendingInstantiations.swap(SavedPendingInstantiations);
-  }
 
   EnterExpressionEvaluationContext EvalContext(*this,
                                                Sema::PotentiallyEvaluated);
@@ -3816,9 +3814,7 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
     VTableUses.swap(SavedVTableUses);
 
     // Restore the set of pending implicit instantiations.
-    assert(PendingInstantiations.empty() &&
-           "PendingInstantiations should be empty before it is discarded.");
-    PendingInstantiations.swap(SavedPendingInstantiations);
+    SavedPendingInstantiations.restore();
   }
 }
 
@@ -4135,11 +4131,10 @@ void Sema::InstantiateVariableDefinition(SourceLocation PointOfInstantiation,
       // queue of pending implicit instantiations that we will instantiate
       // later, while we're still within our own instantiation context.
       SmallVector<VTableUse, 16> SavedVTableUses;
-      std::deque<PendingImplicitInstantiation> SavedPendingInstantiations;
-      if (Recursive) {
+      SavePendingInstantiationsRAII SavedPendingInstantiations(*this,
+                                                               Recursive);
+      if (Recursive)
         VTableUses.swap(SavedVTableUses);
-        PendingInstantiations.swap(SavedPendingInstantiations);
-      }
 
       LocalInstantiationScope Local(*this);
 
@@ -4172,9 +4167,7 @@ void Sema::InstantiateVariableDefinition(SourceLocation PointOfInstantiation,
         VTableUses.swap(SavedVTableUses);
 
         // Restore the set of pending implicit instantiations.
-        assert(PendingInstantiations.empty() &&
-               "PendingInstantiations should be empty before it is discarded.");
-        PendingInstantiations.swap(SavedPendingInstantiations);
+        SavedPendingInstantiations.restore();
       }
     }
 
@@ -4259,13 +4252,11 @@ void Sema::InstantiateVariableDefinition(SourceLocation PointOfInstantiation,
   // queue of pending implicit instantiations that we will instantiate later,
   // while we're still within our own instantiation context.
   SmallVector<VTableUse, 16> SavedVTableUses;
-  std::deque<PendingImplicitInstantiation> SavedPendingInstantiations;
+  SavePendingInstantiationsRAII SavedPendingInstantiations(*this, Recursive);
   SavePendingLocalImplicitInstantiationsRAII
       SavedPendingLocalImplicitInstantiations(*this);
-  if (Recursive) {
+  if (Recursive)
     VTableUses.swap(SavedVTableUses);
-    PendingInstantiations.swap(SavedPendingInstantiations);
-  }
 
   // Enter the scope of this instantiation. We don't use
   // PushDeclContext because we don't have a scope.
@@ -4337,9 +4328,7 @@ void Sema::InstantiateVariableDefinition(SourceLocation PointOfInstantiation,
     VTableUses.swap(SavedVTableUses);
 
     // Restore the set of pending implicit instantiations.
-    assert(PendingInstantiations.empty() &&
-           "PendingInstantiations should be empty before it is discarded.");
-    PendingInstantiations.swap(SavedPendingInstantiations);
+    SavedPendingInstantiations.restore();
   }
 }
 
@@ -4949,11 +4938,17 @@ NamedDecl *Sema::FindInstantiatedDecl(SourceLocation Loc, NamedDecl *D,
 /// \brief Performs template instantiation for all implicit template
 /// instantiations we have seen until this point.
 void Sema::PerformPendingInstantiations(bool LocalOnly) {
+  // The templates of some instantiations a prefix requires may only be
+  // defined by the translation units using it.
+  bool KeepUndefined = TUKind == TU_Prefix && LangOpts.PCHInstantiateTemplates;
+
   while (!PendingLocalImplicitInstantiations.empty() ||
          (!LocalOnly && !PendingInstantiations.empty())) {
     PendingImplicitInstantiation Inst;
+    ++NumPendingInstantiationsPerformed;
 
-    if (PendingLocalImplicitInstantiations.empty()) {
+    bool IsLocal = !PendingLocalImplicitInstantiations.empty();
+    if (!IsLocal) {
       Inst = PendingInstantiations.front();
       PendingInstantiations.pop_front();
     } else {
@@ -4969,6 +4964,8 @@ void Sema::PerformPendingInstantiations(bool LocalOnly) {
                                 TSK_ExplicitInstantiationDefinition;
       InstantiateFunctionDefinition(/*FIXME:*/Inst.second, Function, true,
                                     DefinitionRequired);
+      if (KeepUndefined && !IsLocal && !Function->isDefined())
+        PendingInstantiationsAfterPrefix.push_back(Inst);
       continue;
     }
 
@@ -5010,6 +5007,8 @@ void Sema::PerformPendingInstantiations(bool LocalOnly) {
     // specializations.
     InstantiateVariableDefinition(/*FIXME:*/ Inst.second, Var, true,
                                   DefinitionRequired);
+    if (KeepUndefined && !IsLocal && !Var->getDefinition())
+      PendingInstantiationsAfterPrefix.push_back(Inst);
   }
 }
 
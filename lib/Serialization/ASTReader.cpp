@@ -1189,6 +1189,14 @@ bool ASTReader::ReadSLocEntry(int ID) {
       return true;
 
     SourceLocation IncludeLoc = ReadSourceLocation(*F, Record[1]);
+    if (IncludeLoc.isInvalid() && F->Kind == MK_Preamble) {
+      // This is the file the preamble was built from. Main files that start
+      // with the same text can share a preamble, so it stands for the main
+      // file being parsed.
+      if (const FileEntry *MainFile =
+              SourceMgr.getFileEntryForID(SourceMgr.getMainFileID()))
+        File = MainFile;
+    }
     if (IncludeLoc.isInvalid() && F->Kind != MK_MainFile) {
       // This is the module's main file.
       IncludeLoc = getImportLocation(F);
@@ -30,6 +30,11 @@ STATISTIC(NumBlocks,
           "The # of blocks in top level functions");
 STATISTIC(NumBlocksUnreachable,
           "The # of unreachable blocks in analyzing top level functions");
+STATISTIC(MaxNodesInGraph,
+          "The maximum # of exploded nodes of a top level function");
+STATISTIC(MaxGraphMemory,
+          "The maximum # of kilobytes allocated for the exploded nodes and "
+          "states of a top level function");
 
 namespace {
 class AnalyzerStatsChecker : public Checker<check::EndAnalysis> {
@@ -106,11 +111,22 @@ void AnalyzerStatsChecker::checkEndAnalysis(ExplodedGraph &G,
   NumBlocks += total;
   std::string NameOfRootFunction = output.str();
 
+  // The nodes and the states of the graph share one allocator.
+  unsigned Nodes = G.size();
+  uint64_t GraphMemory = G.getAllocator().getTotalMemory();
+  unsigned GraphMemoryKB = GraphMemory >> 10;
+  MaxNodesInGraph = MaxNodesInGraph < Nodes ? Nodes : MaxNodesInGraph;
+  MaxGraphMemory =
+      MaxGraphMemory < GraphMemoryKB ? GraphMemoryKB : MaxGraphMemory;
+
   output << " -> Total CFGBlocks: " << total << " | Unreachable CFGBlocks: "
       << unreachable << " | Exhausted Block: "
       << (Eng.wasBlocksExhausted() ? "yes" : "no")
       << " | Empty WorkList: "
-      << (Eng.hasEmptyWorkList() ? "yes" : "no");
+      << (Eng.hasEmptyWorkList() ? "yes" : "no")
+      << " | Nodes: " << Nodes
+      << " | Live States: " << Eng.getStateManager().getNumLiveStates()
+      << " | Graph Memory: " << GraphMemory;
 
   B.EmitBasicReport(D, this, "Analyzer Statistics", "Internal Statistics",
                     output.str(), PathDiagnosticLocation(D, SM));
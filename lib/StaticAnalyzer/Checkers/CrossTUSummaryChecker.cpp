@@ -0,0 +1,444 @@
+//== CrossTUSummaryChecker.cpp - Cross translation unit summaries -*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This defines CrossTUSummaryChecker, which records summaries of the functions
+// it analyzes, whether as top level or inlined, into a summary file, and uses
+// the summaries recorded for other translation units to model calls to
+// functions without a body.
+//
+// A summary file has one line per function: its mangled name followed by the
+// facts that hold on every path through it:
+//
+//   nonnull-return  The function returns a pointer that is never null.
+//   noreturn        The function never returns to its caller: its exit cannot
+//                   be reached in its CFG, or every path through it ends in a
+//                   call to a function that does not return. Paths that end
+//                   because of a bug found on them do not make it noreturn.
+//
+// The summaries are recorded with -analyzer-config summary-output=<file>, which
+// appends to the file so that it can be shared by all the translation units of
+// a project, and used with -analyzer-config summary-input=<file>. A function
+// defined in several translation units only keeps the facts that hold in all
+// of them. The facts of a function that is only inlined must hold whatever
+// its caller: it is noreturn if the exit of its CFG cannot be reached, and
+// nonnull-return if every return statement returns an address.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ClangSACheckers.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Mangle.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
+#include "clang/StaticAnalyzer/Core/Checker.h"
+#include "clang/StaticAnalyzer/Core/CheckerManager.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cerrno>
+#if !defined(_MSC_VER) && !defined(__MINGW32__)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+using namespace clang;
+using namespace ento;
+
+namespace {
+
+enum SummaryFact {
+  SF_NonNullReturn = 0x1,
+  SF_NoReturn = 0x2
+};
+
+/// \brief What was seen on the paths of a function, in all of the contexts it
+/// was analyzed in.
+struct PathObservations {
+  bool Returned;
+  bool MayReturnNull;
+
+  PathObservations() : Returned(false), MayReturnNull(false) {}
+};
+
+class CrossTUSummaryChecker : public Checker< check::PreStmt<ReturnStmt>,
+                                              check::EndFunction,
+                                              check::EndAnalysis,
+                                              check::EndOfTranslationUnit,
+                                              check::PostCall > {
+  /// Observations for the functions of the exploded graph being built.
+  mutable llvm::DenseMap<const Decl *, PathObservations> Observations;
+
+  /// The summaries recorded for this translation unit.
+  mutable llvm::StringMap<unsigned> Recorded;
+
+  /// The summaries of the functions in other translation units.
+  llvm::StringMap<unsigned> Summaries;
+
+  mutable std::unique_ptr<MangleContext> Mangler;
+
+  StringRef getFunctionName(const FunctionDecl *FD, ASTContext &Ctx,
+                            SmallVectorImpl<char> &Buf) const;
+
+  bool allPathsEndInNoReturnCalls(const ExplodedGraph &G) const;
+
+  void recordFacts(StringRef Name, unsigned Facts) const;
+
+public:
+  std::string OutputFile;
+
+  /// \brief Read the summaries in \p Filename.
+  void loadSummaries(StringRef Filename);
+
+  void checkPreStmt(const ReturnStmt *RS, CheckerContext &C) const;
+  void checkEndFunction(CheckerContext &C) const;
+  void checkEndAnalysis(ExplodedGraph &G, BugReporter &BR,
+                        ExprEngine &Eng) const;
+  void checkEndOfTranslationUnit(const TranslationUnitDecl *TU,
+                                 AnalysisManager &Mgr,
+                                 BugReporter &BR) const;
+  void checkPostCall(const CallEvent &Call, CheckerContext &C) const;
+};
+
+} // end anonymous namespace
+
+/// \brief Returns the function a summary can be recorded for or applied to,
+/// if any.
+static const FunctionDecl *getSummarizableFunction(const Decl *D) {
+  const FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(D);
+  if (!FD || !FD->isExternallyVisible())
+    return nullptr;
+  if (isa<CXXConstructorDecl>(FD) || isa<CXXDestructorDecl>(FD))
+    return nullptr;
+  return FD;
+}
+
+StringRef CrossTUSummaryChecker::getFunctionName(const FunctionDecl *FD,
+                                                 ASTContext &Ctx,
+                                                 SmallVectorImpl<char> &Buf)
+    const {
+  if (!Mangler)
+    Mangler.reset(Ctx.createMangleContext());
+  if (!Mangler->shouldMangleDeclName(FD))
+    return FD->getName();
+  llvm::raw_svector_ostream OS(Buf);
+  Mangler->mangleName(FD, OS);
+  return OS.str();
+}
+
+/// \brief Returns true if the exit block of \p Cfg can be reached from its
+/// entry without going through a call to a noreturn function.
+static bool isExitReachable(const CFG &Cfg) {
+  llvm::BitVector Visited(Cfg.getNumBlockIDs());
+  SmallVector<const CFGBlock *, 32> Worklist;
+  Worklist.push_back(&Cfg.getEntry());
+  Visited[Cfg.getEntry().getBlockID()] = true;
+
+  while (!Worklist.empty()) {
+    const CFGBlock *B = Worklist.pop_back_val();
+    if (B == &Cfg.getExit())
+      return true;
+    // Noreturn blocks are tied to the exit block only to keep it reachable.
+    if (B->hasNoReturnElement())
+      continue;
+    for (CFGBlock::const_succ_iterator I = B->succ_begin(), E = B->succ_end();
+         I != E; ++I) {
+      const CFGBlock *Succ = *I;
+      if (Succ && !Visited[Succ->getBlockID()]) {
+        Visited[Succ->getBlockID()] = true;
+        Worklist.push_back(Succ);
+      }
+    }
+  }
+  return false;
+}
+
+/// \brief Returns true if every path of \p G that was cut short ended in a
+/// call that does not return, rather than in a sink generated for a bug or
+/// for an analysis limit.
+bool CrossTUSummaryChecker::allPathsEndInNoReturnCalls(
+    const ExplodedGraph &G) const {
+  for (ExplodedGraph::const_node_iterator I = G.nodes_begin(),
+                                          E = G.nodes_end();
+       I != E; ++I) {
+    if (!I->isSink())
+      continue;
+    const ProgramPointTag *Tag = I->getLocation().getTag();
+    if (!Tag || !I->getLocation().getAs<PostStmt>())
+      return false;
+    // Calls known not to return are modeled by NoReturnFunctionChecker, and
+    // those summarized as noreturn by this checker.
+    if (Tag != this &&
+        Tag->getTagDescription() != "core.builtin.NoReturnFunctions")
+      return false;
+  }
+  return true;
+}
+
+void CrossTUSummaryChecker::loadSummaries(StringRef Filename) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Filename);
+  if (!Buffer)
+    return;
+
+  SmallVector<StringRef, 16> Lines;
+  Buffer.get()->getBuffer().split(Lines, "\n", -1, /*KeepEmpty=*/false);
+  for (unsigned I = 0, E = Lines.size(); I != E; ++I) {
+    SmallVector<StringRef, 4> Fields;
+    Lines[I].split(Fields, " ", -1, /*KeepEmpty=*/false);
+    if (Fields.empty())
+      continue;
+
+    unsigned Facts = 0;
+    for (unsigned F = 1, FE = Fields.size(); F != FE; ++F) {
+      if (Fields[F] == "nonnull-return")
+        Facts |= SF_NonNullReturn;
+      else if (Fields[F] == "noreturn")
+        Facts |= SF_NoReturn;
+    }
+
+    llvm::StringMap<unsigned>::iterator It = Summaries.find(Fields[0]);
+    if (It == Summaries.end())
+      Summaries[Fields[0]] = Facts;
+    else
+      It->second &= Facts;
+  }
+}
+
+void CrossTUSummaryChecker::recordFacts(StringRef Name, unsigned Facts) const {
+  llvm::StringMap<unsigned>::iterator It = Recorded.find(Name);
+  if (It == Recorded.end())
+    Recorded[Name] = Facts;
+  else
+    It->second &= Facts;
+}
+
+/// \brief Returns true if \p E cannot evaluate to a null pointer, whatever
+/// the state it is evaluated in.
+static bool isNonNullExpr(const Expr *E) {
+  E = E->IgnoreParens();
+  if (const CastExpr *CE = dyn_cast<CastExpr>(E)) {
+    switch (CE->getCastKind()) {
+    case CK_ArrayToPointerDecay:
+    case CK_FunctionToPointerDecay:
+      return true;
+    case CK_NoOp:
+    case CK_BitCast:
+      return isNonNullExpr(CE->getSubExpr());
+    default:
+      return false;
+    }
+  }
+  if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E))
+    return UO->getOpcode() == UO_AddrOf;
+  return isa<StringLiteral>(E);
+}
+
+/// \brief Returns true if every return statement in \p S returns a value
+/// that cannot be null.
+static bool allReturnsAreNonNull(const Stmt *S) {
+  if (!S)
+    return true;
+  if (const ReturnStmt *RS = dyn_cast<ReturnStmt>(S))
+    if (!RS->getRetValue() || !isNonNullExpr(RS->getRetValue()))
+      return false;
+  for (Stmt::const_child_iterator I = S->child_begin(), E = S->child_end();
+       I != E; ++I)
+    if (!allReturnsAreNonNull(*I))
+      return false;
+  return true;
+}
+
+void CrossTUSummaryChecker::checkPreStmt(const ReturnStmt *RS,
+                                         CheckerContext &C) const {
+  if (OutputFile.empty())
+    return;
+
+  const Expr *RetE = RS->getRetValue();
+  if (!RetE || !RetE->getType()->isAnyPointerType())
+    return;
+
+  PathObservations &Obs = Observations[C.getStackFrame()->getDecl()];
+  if (Obs.MayReturnNull)
+    return;
+
+  Optional<DefinedOrUnknownSVal> RetVal =
+      C.getSVal(RetE).getAs<DefinedOrUnknownSVal>();
+  if (!RetVal || C.getState()->assume(*RetVal, false))
+    Obs.MayReturnNull = true;
+}
+
+void CrossTUSummaryChecker::checkEndFunction(CheckerContext &C) const {
+  if (OutputFile.empty())
+    return;
+  Observations[C.getStackFrame()->getDecl()].Returned = true;
+}
+
+void CrossTUSummaryChecker::checkEndAnalysis(ExplodedGraph &G,
+                                             BugReporter &BR,
+                                             ExprEngine &Eng) const {
+  if (OutputFile.empty())
+    return;
+
+  llvm::DenseMap<const Decl *, PathObservations> GraphObservations;
+  GraphObservations.swap(Observations);
+
+  // Facts about all the paths only hold if all the paths were explored.
+  if (Eng.hasWorkRemaining())
+    return;
+
+  // Find the functions inlined into the top level one, leaving out those
+  // whose paths were cut short by the block count limit and replayed without
+  // inlining.
+  const ExplodedNode *GraphRoot = *G.roots_begin();
+  const Decl *TopLevel =
+      GraphRoot->getLocation().getLocationContext()->getDecl();
+  llvm::SmallPtrSet<const Decl *, 8> Inlined, Exhausted;
+  for (ExplodedGraph::const_node_iterator I = G.nodes_begin(),
+                                          E = G.nodes_end();
+       I != E; ++I) {
+    const Decl *D = I->getStackFrame()->getDecl();
+    if (D == TopLevel)
+      continue;
+    Inlined.insert(D);
+    const ProgramPointTag *Tag = I->getLocation().getTag();
+    if (I->isSink() && Tag &&
+        Tag->getTagDescription() == "ExprEngine : Block count exceeded")
+      Exhausted.insert(D);
+  }
+
+  ASTContext &Ctx = Eng.getContext();
+  SmallString<128> Buf;
+  if (const FunctionDecl *FD = getSummarizableFunction(TopLevel)) {
+    PathObservations Obs = GraphObservations.lookup(TopLevel);
+    unsigned Facts = 0;
+    if (!Obs.Returned) {
+      // A function whose paths all end in bugs is not known not to return;
+      // summarizing it as noreturn would hide the bugs after its calls.
+      const CFG *Cfg = Eng.getAnalysisManager().getCFG(TopLevel);
+      if ((Cfg && !isExitReachable(*Cfg)) || allPathsEndInNoReturnCalls(G))
+        Facts |= SF_NoReturn;
+    } else if (FD->getReturnType()->isAnyPointerType() && !Obs.MayReturnNull)
+      Facts |= SF_NonNullReturn;
+    recordFacts(getFunctionName(FD, Ctx, Buf), Facts);
+  }
+
+  for (llvm::SmallPtrSet<const Decl *, 8>::iterator I = Inlined.begin(),
+                                                    E = Inlined.end();
+       I != E; ++I) {
+    const FunctionDecl *FD = getSummarizableFunction(*I);
+    if (!FD || Exhausted.count(*I))
+      continue;
+    // The state of an inlined call also holds the assumptions of its caller,
+    // which other callers do not share: the paths it rules out may return or
+    // return null. Only what holds whatever the caller is recorded.
+    PathObservations Obs = GraphObservations.lookup(FD);
+    unsigned Facts = 0;
+    if (!Obs.Returned) {
+      const CFG *Cfg = Eng.getAnalysisManager().getCFG(FD);
+      if (Cfg && !isExitReachable(*Cfg))
+        Facts |= SF_NoReturn;
+    } else if (FD->getReturnType()->isAnyPointerType() && !Obs.MayReturnNull &&
+               allReturnsAreNonNull(FD->getBody()))
+      Facts |= SF_NonNullReturn;
+    Buf.clear();
+    recordFacts(getFunctionName(FD, Ctx, Buf), Facts);
+  }
+}
+
+void CrossTUSummaryChecker::checkEndOfTranslationUnit(
+    const TranslationUnitDecl *TU, AnalysisManager &Mgr,
+    BugReporter &BR) const {
+  if (OutputFile.empty() || Recorded.empty())
+    return;
+
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  for (llvm::StringMap<unsigned>::const_iterator I = Recorded.begin(),
+                                                 E = Recorded.end();
+       I != E; ++I) {
+    OS << I->getKey();
+    if (I->getValue() & SF_NonNullReturn)
+      OS << " nonnull-return";
+    if (I->getValue() & SF_NoReturn)
+      OS << " noreturn";
+    OS << '\n';
+  }
+  OS.flush();
+
+  // Translation units analyzed in parallel append to the same file, so the
+  // summaries are written by a single write to the file opened for
+  // appending, which is not interleaved with the writes of others.
+  int FD;
+  std::error_code EC = llvm::sys::fs::openFileForWrite(
+      OutputFile, FD, llvm::sys::fs::F_Append | llvm::sys::fs::F_Text);
+  if (!EC) {
+    auto Written = ::write(FD, Contents.data(), Contents.size());
+    if (Written < 0)
+      EC = std::error_code(errno, std::generic_category());
+    else if (size_t(Written) != Contents.size())
+      EC = std::make_error_code(std::errc::io_error);
+    ::close(FD);
+  }
+  if (EC) {
+    llvm::errs() << "warning: could not write analyzer summaries to '"
+                 << OutputFile << "': " << EC.message() << '\n';
+    return;
+  }
+  Recorded.clear();
+}
+
+void CrossTUSummaryChecker::checkPostCall(const CallEvent &Call,
+                                          CheckerContext &C) const {
+  if (Summaries.empty())
+    return;
+
+  // Calls to functions with a body in this translation unit are modeled by
+  // inlining them.
+  const FunctionDecl *FD = getSummarizableFunction(Call.getDecl());
+  if (!FD || FD->hasBody())
+    return;
+
+  SmallString<128> Buf;
+  llvm::StringMap<unsigned>::const_iterator It =
+      Summaries.find(getFunctionName(FD, C.getASTContext(), Buf));
+  if (It == Summaries.end())
+    return;
+
+  if (It->second & SF_NoReturn) {
+    C.generateSink();
+    return;
+  }
+
+  if (It->second & SF_NonNullReturn) {
+    Optional<DefinedOrUnknownSVal> RetVal =
+        Call.getReturnValue().getAs<DefinedOrUnknownSVal>();
+    if (!RetVal)
+      return;
+    if (ProgramStateRef State = C.getState()->assume(*RetVal, true))
+      C.addTransition(State);
+  }
+}
+
+void ento::registerCrossTUSummaryChecker(CheckerManager &Mgr) {
+  CrossTUSummaryChecker *Checker = Mgr.registerChecker<CrossTUSummaryChecker>();
+  AnalyzerOptions &Opts = Mgr.getAnalyzerOptions();
+  Checker->OutputFile = Opts.getOptionAsString("summary-output", "");
+  StringRef InputFile = Opts.getOptionAsString("summary-input", "");
+  if (!InputFile.empty())
+    Checker->loadSummaries(InputFile);
+}
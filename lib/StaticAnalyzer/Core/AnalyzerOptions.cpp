@@ -209,6 +209,11 @@ int AnalyzerOptions::getOptionAsInteger(StringRef Name, int DefaultVal) {
   return Res;
 }
 
+StringRef AnalyzerOptions::getOptionAsString(StringRef Name,
+                                             StringRef DefaultVal) {
+  return Config.GetOrCreateValue(Name, DefaultVal).getValue();
+}
+
 unsigned AnalyzerOptions::getAlwaysInlineSize() {
   if (!AlwaysInlineSize.hasValue())
     AlwaysInlineSize = getOptionAsInteger("ipa-always-inline-size", 3);
@@ -242,6 +247,12 @@ unsigned AnalyzerOptions::getGraphTrimInterval() {
   return GraphTrimInterval.getValue();
 }
 
+unsigned AnalyzerOptions::getCFGCacheSize() {
+  if (!CFGCacheSize.hasValue())
+    CFGCacheSize = getOptionAsInteger("cfg-cache-size", 256);
+  return CFGCacheSize.getValue();
+}
+
 unsigned AnalyzerOptions::getMaxTimesInlineLarge() {
   if (!MaxTimesInlineLarge.hasValue())
     MaxTimesInlineLarge = getOptionAsInteger("max-times-inline-large", 32);
@@ -267,6 +278,26 @@ unsigned AnalyzerOptions::getMaxNodesPerTopLevelFunction() {
   return MaxNodesPerTopLevelFunction.getValue();
 }
 
+unsigned AnalyzerOptions::getMaxGraphMemory() {
+  if (!MaxGraphMemory.hasValue())
+    MaxGraphMemory = getOptionAsInteger("max-graph-memory", 0);
+  return MaxGraphMemory.getValue();
+}
+
+unsigned AnalyzerOptions::getNumAnalysisShards() {
+  if (!NumAnalysisShards.hasValue()) {
+    int Value = getOptionAsInteger("shard-count", 1);
+    NumAnalysisShards = Value < 1 ? 1 : Value;
+  }
+  return NumAnalysisShards.getValue();
+}
+
+unsigned AnalyzerOptions::getAnalysisShardIndex() {
+  if (!AnalysisShardIndex.hasValue())
+    AnalysisShardIndex = getOptionAsInteger("shard-index", 0);
+  return AnalysisShardIndex.getValue();
+}
+
 bool AnalyzerOptions::shouldSynthesizeBodies() {
   return getBooleanOption("faux-bodies", true);
 }
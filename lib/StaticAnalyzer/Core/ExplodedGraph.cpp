@@ -26,6 +26,14 @@
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "ExplodedGraph"
+
+STATISTIC(NumAggressiveReclamations,
+          "The # of exploded graphs that used half of their memory budget and "
+          "switched to aggressive node reclamation");
+STATISTIC(NumReachedMemoryBudget,
+          "The # of exploded graphs that used all of their memory budget");
+
 //===----------------------------------------------------------------------===//
 // Node auditing.
 //===----------------------------------------------------------------------===//
@@ -48,7 +56,8 @@ void ExplodedNode::SetAuditor(ExplodedNode::Auditor* A) {
 //===----------------------------------------------------------------------===//
 
 ExplodedGraph::ExplodedGraph()
-  : NumNodes(0), ReclaimNodeInterval(0) {}
+  : NumNodes(0), ReclaimNodeInterval(0), MemoryBudget(0),
+    AggressiveReclamation(false), OverMemoryBudget(false) {}
 
 ExplodedGraph::~ExplodedGraph() {}
 
@@ -134,19 +143,24 @@ bool ExplodedGraph::shouldCollect(const ExplodedNode *node) {
   if (!Ex)
     return false;
 
-  // Condition 8.
-  // Do not collect nodes for "interesting" lvalue expressions since they are
-  // used extensively for generating path diagnostics.
-  if (isInterestingLValueExpr(Ex))
-    return false;
+  // Conditions 8 and 9 only serve the precision of the path diagnostics, and
+  // are dropped when the graph is running out of memory. Condition 10 is
+  // always checked, as replaying a call without inlining depends on it.
+  if (!AggressiveReclamation) {
+    // Condition 8.
+    // Do not collect nodes for "interesting" lvalue expressions since they
+    // are used extensively for generating path diagnostics.
+    if (isInterestingLValueExpr(Ex))
+      return false;
 
-  // Condition 9.
-  // Do not collect nodes for non-consumed Stmt or Expr to ensure precise
-  // diagnostic generation; specifically, so that we could anchor arrows
-  // pointing to the beginning of statements (as written in code).
-  ParentMap &PM = progPoint.getLocationContext()->getParentMap();
-  if (!PM.isConsumedExpr(Ex))
-    return false;
+    // Condition 9.
+    // Do not collect nodes for non-consumed Stmt or Expr to ensure precise
+    // diagnostic generation; specifically, so that we could anchor arrows
+    // pointing to the beginning of statements (as written in code).
+    ParentMap &PM = progPoint.getLocationContext()->getParentMap();
+    if (!PM.isConsumedExpr(Ex))
+      return false;
+  }
 
   // Condition 10.
   const ProgramPoint SuccLoc = succ->getLocation();
@@ -189,6 +203,18 @@ void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
     return;
   ReclaimCounter = ReclaimNodeInterval;
 
+  if (MemoryBudget && !OverMemoryBudget) {
+    size_t MemoryInUse = getAllocator().getTotalMemory();
+    if (!AggressiveReclamation && MemoryInUse >= MemoryBudget / 2) {
+      AggressiveReclamation = true;
+      ++NumAggressiveReclamations;
+    }
+    if (MemoryInUse >= MemoryBudget) {
+      OverMemoryBudget = true;
+      ++NumReachedMemoryBudget;
+    }
+  }
+
   for (NodeVector::iterator it = ChangedNodes.begin(), et = ChangedNodes.end();
        it != et; ++it) {
     ExplodedNode *node = *it;
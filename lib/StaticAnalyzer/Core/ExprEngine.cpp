@@ -81,6 +81,9 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
     // Enable eager node reclaimation when constructing the ExplodedGraph.
     G.enableNodeReclamation(TrimInterval);
   }
+
+  if (unsigned MaxGraphMemory = mgr.options.getMaxGraphMemory())
+    G.setMemoryBudget(static_cast<size_t>(MaxGraphMemory) << 20);
 }
 
 ExprEngine::~ExprEngine() {
@@ -873,7 +873,9 @@ bool ExprEngine::shouldInlineCall(const CallEvent &Call, const Decl *D,
     return false;
   }
 
-  if (HowToInline == Inline_Minimal &&
+  // Once the exploded graph has used up its memory budget, keep exploring
+  // with minimal inlining rather than running out of memory.
+  if ((HowToInline == Inline_Minimal || G.isOverMemoryBudget()) &&
       (CalleeCFG->getNumBlockIDs() > Opts.getAlwaysInlineSize()
       || IsRecursive))
     return false;
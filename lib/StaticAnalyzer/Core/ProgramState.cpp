@@ -17,11 +17,22 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/TaintManager.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "ProgramState"
+
+STATISTIC(NumStatesCreated, "The # of distinct program states created");
+STATISTIC(NumStatesShared,
+          "The # of times an existing program state was shared instead of "
+          "creating a new one");
+STATISTIC(NumStatesRecycled,
+          "The # of program states created in the memory of a released "
+          "state");
+
 namespace clang { namespace  ento {
 /// Increments the number of times this state is referenced.
 
@@ -384,13 +395,17 @@ ProgramStateRef ProgramStateManager::getPersistentState(ProgramState &State) {
   State.Profile(ID);
   void *InsertPos;
 
-  if (ProgramState *I = StateSet.FindNodeOrInsertPos(ID, InsertPos))
+  if (ProgramState *I = StateSet.FindNodeOrInsertPos(ID, InsertPos)) {
+    ++NumStatesShared;
     return I;
+  }
 
+  ++NumStatesCreated;
   ProgramState *newState = nullptr;
   if (!freeStates.empty()) {
     newState = freeStates.back();
     freeStates.pop_back();    
+    ++NumStatesRecycled;
   }
   else {
     newState = (ProgramState*) Alloc.Allocate<ProgramState>();
@@ -33,6 +33,7 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -151,6 +152,14 @@ class AnalysisConsumer : public AnalysisASTConsumer,
   /// Bug Reporter to use while recursively visiting Decls.
   BugReporter *RecVisitorBR;
 
+  /// The number of shards the analysis is split into, and the one to analyze.
+  unsigned NumShards;
+  unsigned ShardIndex;
+
+  /// The shard of each function in the call graph: that of the first root
+  /// of the call graph it is reachable from.
+  llvm::DenseMap<const Decl *, unsigned> ShardOfDecl;
+
 public:
   ASTContext *Ctx;
   const Preprocessor &PP;
@@ -185,7 +194,7 @@ public:
                    const std::string& outdir,
                    AnalyzerOptionsRef opts,
                    ArrayRef<std::string> plugins)
-    : RecVisitorMode(0), RecVisitorBR(nullptr),
+    : RecVisitorMode(0), RecVisitorBR(nullptr), NumShards(1), ShardIndex(0),
       Ctx(nullptr), PP(pp), OutDir(outdir), Opts(opts), Plugins(plugins) {
     DigestAnalyzerOptions();
     if (Opts->PrintStats) {
@@ -294,6 +303,8 @@ public:
                                   CreateConstraintMgr,
                                   checkerMgr.get(),
                                   *Opts));
+    NumShards = Opts->getNumAnalysisShards();
+    ShardIndex = Opts->getAnalysisShardIndex();
   }
 
   /// \brief Store the top level decls in the set to be processed later on.
@@ -383,6 +394,15 @@ private:
   /// \brief Check if we should skip (not analyze) the given function.
   AnalysisMode getModeForDecl(Decl *D, AnalysisMode Mode);
 
+  /// \brief Check if the path-sensitive analysis of the given function
+  /// belongs to the shard being analyzed.
+  bool isInAnalysisShard(const Decl *D);
+
+  /// \brief Assign the functions of the call graph traversed by \p RPOT to
+  /// shards.
+  void assignShards(
+      llvm::ReversePostOrderTraversal<clang::CallGraph *> &RPOT);
+
 };
 } // end anonymous namespace
 
@@ -469,6 +489,7 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
+  assignShards(RPOT);
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
     NumFunctionTopLevel++;
@@ -512,7 +533,8 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // Introduce a scope to destroy BR before Mgr.
     BugReporter BR(*Mgr);
     TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+    if (ShardIndex == 0)
+      checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
 
     // Run the AST-only checks using the order in which functions are defined.
     // If inlining is not turned on, use the simplest function order for path
@@ -537,7 +559,8 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
       HandleDeclsCallGraph(LocalTUDeclsSize);
 
     // After all decls handled, run checkers on the entire TranslationUnit.
-    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+    if (ShardIndex == 0)
+      checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
     RecVisitorBR = nullptr;
   }
@@ -587,12 +610,85 @@ AnalysisConsumer::getModeForDecl(Decl *D, AnalysisMode Mode) {
   if (!Opts->AnalyzeAll && !SM.isInMainFile(SL)) {
     if (SL.isInvalid() || SM.isInSystemHeader(SL))
       return AM_None;
-    return Mode & ~AM_Path;
+    Mode &= ~AM_Path;
   }
 
+  // When the analysis is sharded, the AST-based checks are run by the first
+  // shard, and each shard analyzes its own subset of the functions.
+  if (ShardIndex != 0)
+    Mode &= ~AM_Syntax;
+  if ((Mode & AM_Path) && !isInAnalysisShard(D))
+    Mode &= ~AM_Path;
+
   return Mode;
 }
 
+/// \brief Returns a hash of the location of \p D that is the same in every
+/// analyzer invocation over the translation unit.
+static unsigned getStableLocationHash(const SourceManager &SM, const Decl *D) {
+  std::pair<FileID, unsigned> Loc =
+      SM.getDecomposedExpansionLoc(D->getLocation());
+  // FNV-1a over the file and the offset.
+  uint32_t Hash = 2166136261u;
+  uint32_t Values[] = { uint32_t(Loc.first.getHashValue()), Loc.second };
+  for (uint32_t Value : Values)
+    for (unsigned Byte = 0; Byte != 4; ++Byte) {
+      Hash ^= (Value >> (Byte * 8)) & 0xff;
+      Hash *= 16777619u;
+    }
+  return Hash;
+}
+
+void AnalysisConsumer::assignShards(
+    llvm::ReversePostOrderTraversal<clang::CallGraph *> &RPOT) {
+  ShardOfDecl.clear();
+  if (NumShards == 1)
+    return;
+
+  // The unsharded analysis only analyzes a function as top level if it was
+  // not inlined into a function analyzed before it. So that the shards
+  // together analyze the same functions, each root of the call graph, i.e.
+  // each function without callers in the translation unit, is assigned by
+  // its location, and the functions it calls go to the shard of the first
+  // root they are reachable from. The traversal visits callers before their
+  // callees, except along cycles.
+  SourceManager &SM = Ctx->getSourceManager();
+  for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
+         I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
+    CallGraphNode *N = *I;
+    // The abstract root node calls every function.
+    if (!N->getDecl())
+      continue;
+
+    unsigned Shard;
+    llvm::DenseMap<const Decl *, unsigned>::iterator Known =
+        ShardOfDecl.find(N->getDecl());
+    if (Known != ShardOfDecl.end()) {
+      Shard = Known->second;
+    } else {
+      Shard = getStableLocationHash(SM, N->getDecl()) % NumShards;
+      ShardOfDecl[N->getDecl()] = Shard;
+    }
+
+    for (CallGraphNode::iterator C = N->begin(), CE = N->end(); C != CE; ++C)
+      if (const Decl *Callee = (*C)->getDecl())
+        ShardOfDecl.insert(std::make_pair(Callee, Shard));
+  }
+}
+
+bool AnalysisConsumer::isInAnalysisShard(const Decl *D) {
+  if (NumShards == 1)
+    return true;
+
+  llvm::DenseMap<const Decl *, unsigned>::iterator Known =
+      ShardOfDecl.find(D);
+  if (Known != ShardOfDecl.end())
+    return Known->second == ShardIndex;
+  // Functions outside the call graph are assigned by their location.
+  return getStableLocationHash(Ctx->getSourceManager(), D) % NumShards ==
+         ShardIndex;
+}
+
 void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
                                   ExprEngine::InliningModes IMode,
                                   SetOfConstDecls *VisitedCallees) {
@@ -18,9 +18,11 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/Tooling/Refactoring.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_os_ostream.h"
+#include <algorithm>
 
 namespace clang {
 namespace tooling {
@@ -50,31 +52,45 @@ bool Replacement::isApplicable() const {
   return FilePath != InvalidLocation;
 }
 
-bool Replacement::apply(Rewriter &Rewrite) const {
-  SourceManager &SM = Rewrite.getSourceMgr();
+/// \brief Returns the start of the file at \p FilePath in \p SM, or an
+/// invalid location if there is no such file.
+static SourceLocation getStartOfFile(SourceManager &SM, StringRef FilePath) {
   const FileEntry *Entry = SM.getFileManager().getFile(FilePath);
   if (!Entry)
-    return false;
+    return SourceLocation();
   FileID ID;
   // FIXME: Use SM.translateFile directly.
   SourceLocation Location = SM.translateFileLineCol(Entry, 1, 1);
   ID = Location.isValid() ?
     SM.getFileID(Location) :
     SM.createFileID(Entry, SourceLocation(), SrcMgr::C_User);
+  return SM.getLocForStartOfFile(ID);
+}
+
+/// \brief Applies \p Replace to the file starting at \p StartOfFile.
+static bool applyAt(const Replacement &Replace, SourceLocation StartOfFile,
+                    Rewriter &Rewrite) {
   // FIXME: We cannot check whether Offset + Length is in the file, as
   // the remapping API is not public in the RewriteBuffer.
   const SourceLocation Start =
-    SM.getLocForStartOfFile(ID).
-    getLocWithOffset(ReplacementRange.getOffset());
+    StartOfFile.getLocWithOffset(Replace.getOffset());
   // ReplaceText returns false on success.
   // ReplaceText only fails if the source location is not a file location, in
   // which case we already returned false earlier.
   bool RewriteSucceeded = !Rewrite.ReplaceText(
-      Start, ReplacementRange.getLength(), ReplacementText);
+      Start, Replace.getLength(), Replace.getReplacementText());
   assert(RewriteSucceeded);
   return RewriteSucceeded;
 }
 
+bool Replacement::apply(Rewriter &Rewrite) const {
+  SourceLocation StartOfFile =
+      getStartOfFile(Rewrite.getSourceMgr(), FilePath);
+  if (StartOfFile.isInvalid())
+    return false;
+  return applyAt(*this, StartOfFile, Rewrite);
+}
+
 std::string Replacement::toString() const {
   std::string result;
   llvm::raw_string_ostream stream(result);
@@ -142,22 +158,72 @@ void Replacement::setFromSourceRange(const SourceManager &Sources,
                         getRangeSize(Sources, Range), ReplacementText);
 }
 
+void Replacements::sortAndDeduplicate() const {
+  if (NumSorted == Replaces.size())
+    return;
+
+  // Sort the new replacements, merge them into the sorted ones, and drop the
+  // duplicates.
+  std::vector<Replacement>::iterator Middle = Replaces.begin() + NumSorted;
+  std::sort(Middle, Replaces.end());
+  std::inplace_merge(Replaces.begin(), Middle, Replaces.end());
+  Replaces.erase(std::unique(Replaces.begin(), Replaces.end()),
+                 Replaces.end());
+  NumSorted = Replaces.size();
+}
+
+std::vector<Replacement> Replacements::getConflicts() const {
+  std::vector<Replacement> Conflicts;
+  // The replacement with the furthest end seen so far in each file; as the
+  // replacements are ordered by offset, a replacement conflicts with an
+  // earlier one if and only if it overlaps with this one.
+  llvm::StringMap<Range> Furthest;
+  for (const Replacement &Replace : *this) {
+    Range Current(Replace.getOffset(), Replace.getLength());
+    llvm::StringMap<Range>::iterator I =
+        Furthest.find(Replace.getFilePath());
+    if (I == Furthest.end()) {
+      Furthest[Replace.getFilePath()] = Current;
+      continue;
+    }
+    if (I->second.overlapsWith(Current))
+      Conflicts.push_back(Replace);
+    if (Current.getOffset() + Current.getLength() >
+        I->second.getOffset() + I->second.getLength())
+      I->second = Current;
+  }
+  return Conflicts;
+}
+
 bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite) {
   bool Result = true;
+  // Look up each file only once.
+  llvm::StringMap<SourceLocation> StartOfFiles;
   for (Replacements::const_iterator I = Replaces.begin(),
                                     E = Replaces.end();
        I != E; ++I) {
-    if (I->isApplicable()) {
-      Result = I->apply(Rewrite) && Result;
-    } else {
+    if (!I->isApplicable()) {
       Result = false;
+      continue;
     }
+    SourceLocation StartOfFile;
+    llvm::StringMap<SourceLocation>::iterator Known =
+        StartOfFiles.find(I->getFilePath());
+    if (Known != StartOfFiles.end())
+      StartOfFile = Known->second;
+    else
+      StartOfFiles[I->getFilePath()] = StartOfFile =
+          getStartOfFile(Rewrite.getSourceMgr(), I->getFilePath());
+    if (StartOfFile.isInvalid())
+      Result = false;
+    else
+      Result = applyAt(*I, StartOfFile, Rewrite) && Result;
   }
   return Result;
 }
 
-// FIXME: Remove this function when Replacements is implemented as std::vector
-// instead of std::set.
+// Unlike a Replacements set, the vector may be unsorted and hold duplicates,
+// e.g. before it is passed to deduplicate().
 bool applyAllReplacements(const std::vector<Replacement> &Replaces,
                           Rewriter &Rewrite) {
   bool Result = true;
@@ -188,11 +254,10 @@ std::string applyAllReplacements(StringRef Code, const Replacements &Replaces) {
   SourceMgr.overrideFileContents(Entry, Buf);
   FileID ID =
       SourceMgr.createFileID(Entry, SourceLocation(), clang::SrcMgr::C_User);
+  SourceLocation StartOfFile = SourceMgr.getLocForStartOfFile(ID);
   for (Replacements::const_iterator I = Replaces.begin(), E = Replaces.end();
        I != E; ++I) {
-    Replacement Replace("<stdin>", I->getOffset(), I->getLength(),
-                        I->getReplacementText());
-    if (!Replace.apply(Rewrite))
+    if (!applyAt(*I, StartOfFile, Rewrite))
       return "";
   }
   std::string Result;
@@ -202,10 +267,13 @@ std::string applyAllReplacements(StringRef Code, const Replacements &Replaces) {
   return Result;
 }
 
-unsigned shiftedCodePosition(const Replacements &Replaces, unsigned Position) {
+/// \brief Returns how \p Position is shifted by the replacements in
+/// [\p Begin, \p End), which are sorted by offset.
+template <typename Iterator>
+static unsigned shiftPosition(Iterator Begin, Iterator End,
+                              unsigned Position) {
   unsigned NewPosition = Position;
-  for (Replacements::iterator I = Replaces.begin(), E = Replaces.end(); I != E;
-       ++I) {
+  for (Iterator I = Begin; I != End; ++I) {
     if (I->getOffset() >= Position)
       break;
     if (I->getOffset() + I->getLength() > Position)
@@ -215,21 +283,13 @@ unsigned shiftedCodePosition(const Replacements &Replaces, unsigned Position) {
   return NewPosition;
 }
 
-// FIXME: Remove this function when Replacements is implemented as std::vector
-// instead of std::set.
+unsigned shiftedCodePosition(const Replacements &Replaces, unsigned Position) {
+  return shiftPosition(Replaces.begin(), Replaces.end(), Position);
+}
+
 unsigned shiftedCodePosition(const std::vector<Replacement> &Replaces,
                              unsigned Position) {
-  unsigned NewPosition = Position;
-  for (std::vector<Replacement>::const_iterator I = Replaces.begin(),
-                                                E = Replaces.end();
-       I != E; ++I) {
-    if (I->getOffset() >= Position)
-      break;
-    if (I->getOffset() + I->getLength() > Position)
-      NewPosition += I->getOffset() + I->getLength() - Position;
-    NewPosition += I->getReplacementText().size() - I->getLength();
-  }
-  return NewPosition;
+  return shiftPosition(Replaces.begin(), Replaces.end(), Position);
 }
 
 void deduplicate(std::vector<Replacement> &Replaces,
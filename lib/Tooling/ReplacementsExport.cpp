@@ -0,0 +1,184 @@
+//===--- ReplacementsExport.cpp - Streaming export of replacements --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  Implements the per translation unit export of replacements to YAML and the
+//  merging of the exported documents.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/ReplacementsExport.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Tooling/ReplacementsYaml.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace tooling {
+
+/// \brief Returns the name of the document for the translation unit
+/// \p MainSourceFile built in \p Configuration; the hash keeps translation
+/// units whose main files share a name, or that build the same main file
+/// differently, apart.
+static std::string getExportFileName(StringRef MainSourceFile,
+                                     StringRef Configuration) {
+  llvm::MD5 Hash;
+  Hash.update(MainSourceFile);
+  if (!Configuration.empty()) {
+    Hash.update(StringRef("\0", 1));
+    Hash.update(Configuration);
+  }
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+  return (llvm::sys::path::filename(MainSourceFile) + "_" + Digest.str() +
+          ".yaml").str();
+}
+
+bool exportReplacements(TranslationUnitReplacements &Doc,
+                        StringRef Directory, std::string &ErrorMessage,
+                        StringRef Configuration) {
+  SmallString<128> Path(Directory);
+  llvm::sys::path::append(
+      Path, getExportFileName(Doc.MainSourceFile, Configuration));
+  SmallString<128> TempPath(Path);
+  TempPath += "-%%%%%%%%";
+
+  int FD;
+  if (std::error_code EC =
+          llvm::sys::fs::createUniqueFile(TempPath.str(), FD, TempPath)) {
+    ErrorMessage = "Error creating " + TempPath.str().str() + ": " +
+                   EC.message();
+    return false;
+  }
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    llvm::yaml::Output YAML(Out);
+    YAML << Doc;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      ErrorMessage = "Error writing " + TempPath.str().str();
+      llvm::sys::fs::remove(TempPath.str());
+      return false;
+    }
+  }
+  if (std::error_code EC = llvm::sys::fs::rename(TempPath.str(), Path.str())) {
+    ErrorMessage = "Error renaming " + TempPath.str().str() + " to " +
+                   Path.str().str() + ": " + EC.message();
+    llvm::sys::fs::remove(TempPath.str());
+    return false;
+  }
+  return true;
+}
+
+bool mergeExportedReplacements(StringRef Directory, Replacements &Merged,
+                               std::string &ErrorMessage) {
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(Directory, EC), E; I != E && !EC;
+       I.increment(EC)) {
+    // Skips the temporary files of exports that are still running.
+    if (llvm::sys::path::extension(I->path()) != ".yaml")
+      continue;
+
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        llvm::MemoryBuffer::getFile(I->path());
+    if (std::error_code ReadError = Buffer.getError()) {
+      ErrorMessage = "Error reading " + I->path() + ": " + ReadError.message();
+      return false;
+    }
+
+    // Only one document is alive at any time; its replacements are merged
+    // into, and deduplicated by, Merged.
+    TranslationUnitReplacements Doc;
+    llvm::yaml::Input YAML((*Buffer)->getBuffer());
+    YAML >> Doc;
+    if (YAML.error()) {
+      ErrorMessage = "Error parsing " + I->path();
+      return false;
+    }
+    Merged.insert(Doc.Replacements.begin(), Doc.Replacements.end());
+  }
+  if (EC) {
+    ErrorMessage = "Error reading " + Directory.str() + ": " + EC.message();
+    return false;
+  }
+  return true;
+}
+
+RefactoringActionFactory::~RefactoringActionFactory() {}
+
+/// \brief Returns a string that differs between invocations that build the
+/// same main file with different language options, target, macros or include
+/// paths.
+static std::string getConfiguration(const CompilerInvocation &Invocation) {
+  std::string Configuration = Invocation.getModuleHash();
+  for (const HeaderSearchOptions::Entry &Entry :
+       Invocation.getHeaderSearchOpts().UserEntries) {
+    Configuration += '\0';
+    Configuration += Entry.Path;
+    Configuration += char('0' + Entry.Group);
+  }
+  return Configuration;
+}
+
+namespace {
+/// \brief Creates the actions of a \c RefactoringActionFactory for a single
+/// translation unit, with the replacements going to a given set.
+class SingleTUActionFactory : public FrontendActionFactory {
+public:
+  SingleTUActionFactory(RefactoringActionFactory &Factory,
+                        Replacements &Replaces)
+      : Factory(Factory), Replaces(Replaces) {}
+
+  FrontendAction *create() override { return Factory.create(Replaces); }
+
+private:
+  RefactoringActionFactory &Factory;
+  Replacements &Replaces;
+};
+} // end anonymous namespace
+
+ExportReplacementsAction::ExportReplacementsAction(
+    RefactoringActionFactory *Factory, StringRef Directory, StringRef Context)
+    : Factory(Factory), Directory(Directory), Context(Context) {}
+
+bool ExportReplacementsAction::runInvocation(CompilerInvocation *Invocation,
+                                             FileManager *Files,
+                                             DiagnosticConsumer *DiagConsumer) {
+  TranslationUnitReplacements Doc;
+  Doc.Context = Context;
+  // The invocation is released by the compiler instance running it.
+  const FrontendOptions &FrontendOpts = Invocation->getFrontendOpts();
+  if (!FrontendOpts.Inputs.empty())
+    Doc.MainSourceFile = FrontendOpts.Inputs[0].getFile();
+  std::string Configuration = getConfiguration(*Invocation);
+
+  Replacements Replaces;
+  SingleTUActionFactory TUFactory(*Factory, Replaces);
+  if (!TUFactory.runInvocation(Invocation, Files, DiagConsumer))
+    return false;
+
+  Doc.Replacements.assign(Replaces.begin(), Replaces.end());
+  std::string ErrorMessage;
+  if (!exportReplacements(Doc, Directory, ErrorMessage, Configuration)) {
+    llvm::errs() << ErrorMessage << "\n";
+    return false;
+  }
+  return true;
+}
+
+} // end namespace tooling
+} // end namespace clang
@@ -14,8 +14,10 @@
 
 #include "clang/Tooling/Tooling.h"
 #include "clang/AST/ASTConsumer.h"
+#include "clang/Basic/WorkerThreads.h"
 #include "clang/Driver/Compilation.h"
 #include "clang/Driver/Driver.h"
+#include "clang/Driver/Options.h"
 #include "clang/Driver/Tool.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -25,11 +27,16 @@
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/MutexGuard.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 
 // For chdir, see the comment in ClangTool::run for more information.
 #ifdef LLVM_ON_WIN32
@@ -196,12 +203,27 @@ void ToolInvocation::mapVirtualFile(StringRef FilePath, StringRef Content) {
   MappedFileContents[PathStorage] = Content;
 }
 
+/// \brief Returns the diagnostic options given on \p Argv, a driver command
+/// line, so that diagnostics are printed as the compiler would print them.
+static IntrusiveRefCntPtr<DiagnosticOptions>
+createDiagnosticOptions(ArrayRef<const char *> Argv) {
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  std::unique_ptr<llvm::opt::OptTable> Opts(driver::createDriverOptTable());
+  unsigned MissingArgIndex, MissingArgCount;
+  std::unique_ptr<llvm::opt::InputArgList> Args(Opts->ParseArgs(
+      Argv.begin() + 1, Argv.end(), MissingArgIndex, MissingArgCount));
+  // Errors in the arguments are diagnosed when the driver parses them.
+  (void) ParseDiagnosticArgs(*DiagOpts, *Args);
+  return DiagOpts;
+}
+
 bool ToolInvocation::run() {
   std::vector<const char*> Argv;
   for (const std::string &Str : CommandLine)
     Argv.push_back(Str.c_str());
   const char *const BinaryName = Argv[0];
-  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts =
+      createDiagnosticOptions(Argv);
   TextDiagnosticPrinter DiagnosticPrinter(
       llvm::errs(), &*DiagOpts);
   DiagnosticsEngine Diagnostics(
@@ -318,7 +340,9 @@ void ClangTool::clearArgumentsAdjusters() {
   ArgsAdjusters.clear();
 }
 
-int ClangTool::run(ToolAction *Action) {
+/// \brief Returns the path of the executable the driver uses to find the
+/// builtin headers.
+static std::string getToolMainExecutable() {
   // Exists solely for the purpose of lookup of the resource path.
   // This just needs to be some symbol in the binary.
   static int StaticSymbol;
@@ -327,8 +351,22 @@ int ClangTool::run(ToolAction *Action) {
   // FIXME: On linux, GetMainExecutable is independent of the value of the
   // first argument, thus allowing ClangTool and runToolOnCode to just
   // pass in made-up names here. Make sure this works on other platforms.
-  std::string MainExecutable =
-      llvm::sys::fs::getMainExecutable("clang_tool", &StaticSymbol);
+  return llvm::sys::fs::getMainExecutable("clang_tool", &StaticSymbol);
+}
+
+std::vector<std::string>
+ClangTool::getAdjustedCommandLine(const CompileCommand &Command,
+                                  StringRef MainExecutable) const {
+  std::vector<std::string> CommandLine = Command.CommandLine;
+  for (ArgumentsAdjuster *Adjuster : ArgsAdjusters)
+    CommandLine = Adjuster->Adjust(CommandLine);
+  assert(!CommandLine.empty());
+  CommandLine[0] = MainExecutable;
+  return CommandLine;
+}
+
+int ClangTool::run(ToolAction *Action) {
+  std::string MainExecutable = getToolMainExecutable();
 
   bool ProcessingFailed = false;
   for (const auto &Command : CompileCommands) {
@@ -342,11 +380,8 @@ int ClangTool::run(ToolAction *Action) {
     if (chdir(Command.second.Directory.c_str()))
       llvm::report_fatal_error("Cannot chdir into \"" +
                                Twine(Command.second.Directory) + "\n!");
-    std::vector<std::string> CommandLine = Command.second.CommandLine;
-    for (ArgumentsAdjuster *Adjuster : ArgsAdjusters)
-      CommandLine = Adjuster->Adjust(CommandLine);
-    assert(!CommandLine.empty());
-    CommandLine[0] = MainExecutable;
+    std::vector<std::string> CommandLine =
+        getAdjustedCommandLine(Command.second, MainExecutable);
     // FIXME: We need a callback mechanism for the tool writer to output a
     // customized message for each file.
     DEBUG({
@@ -368,6 +403,113 @@ int ClangTool::run(ToolAction *Action) {
 
 namespace {
 
+/// \brief Forwards diagnostics to another consumer while holding a lock, so
+/// that the consumer sees them one at a time.
+class LockedDiagnosticConsumer : public DiagnosticConsumer {
+  DiagnosticConsumer &Target;
+  llvm::sys::Mutex &Mux;
+
+public:
+  LockedDiagnosticConsumer(DiagnosticConsumer &Target, llvm::sys::Mutex &Mux)
+      : Target(Target), Mux(Mux) {}
+
+  void BeginSourceFile(const LangOptions &LangOpts,
+                       const Preprocessor *PP) override {
+    llvm::MutexGuard Guard(Mux);
+    Target.BeginSourceFile(LangOpts, PP);
+  }
+
+  void EndSourceFile() override {
+    llvm::MutexGuard Guard(Mux);
+    Target.EndSourceFile();
+  }
+
+  void finish() override {
+    llvm::MutexGuard Guard(Mux);
+    Target.finish();
+  }
+
+  void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
+                        const Diagnostic &Info) override {
+    DiagnosticConsumer::HandleDiagnostic(DiagLevel, Info);
+    llvm::MutexGuard Guard(Mux);
+    Target.HandleDiagnostic(DiagLevel, Info);
+  }
+};
+
+}
+
+int ClangTool::runInParallel(ToolAction *Action, unsigned NumThreads) {
+  std::string MainExecutable = getToolMainExecutable();
+
+  std::atomic<unsigned> NextCommand(0);
+  std::atomic<bool> ProcessingFailed(false);
+  // Guards the diagnostic consumer and llvm::errs().
+  llvm::sys::Mutex OutputMux;
+
+  auto ProcessCommands = [&]() {
+    IntrusiveRefCntPtr<FileManager> WorkerFiles;
+    while (true) {
+      unsigned I = NextCommand++;
+      if (I >= CompileCommands.size())
+        return;
+      const auto &Command = CompileCommands[I];
+      StringRef Directory = Command.second.Directory;
+
+      // Keep the file manager, and thus its caches, as long as the commands
+      // run in the same directory, which is the common case.
+      if (!WorkerFiles ||
+          WorkerFiles->getFileSystemOptions().WorkingDir != Directory) {
+        FileSystemOptions FileSystemOpts;
+        FileSystemOpts.WorkingDir = Directory;
+        WorkerFiles = new FileManager(FileSystemOpts);
+      }
+
+      std::vector<std::string> CommandLine =
+          getAdjustedCommandLine(Command.second, MainExecutable);
+      CommandLine.insert(CommandLine.begin() + 1, "-working-directory");
+      CommandLine.insert(CommandLine.begin() + 2, Directory);
+
+      std::vector<const char *> Argv;
+      for (const std::string &Str : CommandLine)
+        Argv.push_back(Str.c_str());
+      std::string DiagnosticsText;
+      llvm::raw_string_ostream DiagnosticsOS(DiagnosticsText);
+      IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts =
+          createDiagnosticOptions(Argv);
+      TextDiagnosticPrinter DiagnosticPrinter(DiagnosticsOS, &*DiagOpts);
+      DiagnosticConsumer *Consumer = &DiagnosticPrinter;
+      std::unique_ptr<LockedDiagnosticConsumer> LockedConsumer;
+      if (DiagConsumer) {
+        LockedConsumer.reset(
+            new LockedDiagnosticConsumer(*DiagConsumer, OutputMux));
+        Consumer = LockedConsumer.get();
+      }
+
+      ToolInvocation Invocation(std::move(CommandLine), Action,
+                                WorkerFiles.get());
+      Invocation.setDiagnosticConsumer(Consumer);
+      for (const auto &MappedFile : MappedFileContents)
+        Invocation.mapVirtualFile(MappedFile.first, MappedFile.second);
+      bool Success = Invocation.run();
+
+      llvm::MutexGuard Guard(OutputMux);
+      llvm::errs() << DiagnosticsOS.str();
+      if (!Success) {
+        // FIXME: Diagnostics should be used instead.
+        llvm::errs() << "Error while processing " << Command.first << ".\n";
+        ProcessingFailed = true;
+      }
+    }
+  };
+
+  runOnWorkerThreads(ProcessCommands, NumThreads, CompileCommands.size());
+
+  return ProcessingFailed ? 1 : 0;
+}
+
+namespace {
+
 class ASTBuilderAction : public ToolAction {
   std::vector<std::unique_ptr<ASTUnit>> &ASTs;
 
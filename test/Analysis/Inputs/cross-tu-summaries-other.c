@@ -0,0 +1,50 @@
+void abort(void) __attribute__((noreturn));
+
+static int buffer[16];
+
+int *getBuffer(void) {
+  return buffer;
+}
+
+int *findEntry(int i) {
+  return i < 16 ? &buffer[i] : 0;
+}
+
+void fatal(const char *msg) {
+  abort();
+}
+
+static int *getBufferInternal(void) {
+  return buffer;
+}
+
+void crash(void) {
+  int *p = 0;
+  *p = 1;
+}
+
+void spin(void) {
+  for (;;) {
+  }
+}
+
+// Only analyzed inlined into their callers.
+int *getInlinedBuffer(void) {
+  return buffer;
+}
+
+int *getInlinedEntry(int i) {
+  if (i < 16)
+    return &buffer[i];
+  return 0;
+}
+
+void inlinedFatal(void) {
+  abort();
+}
+
+int useInlined(int *p) {
+  if (!p)
+    inlinedFatal();
+  return *getInlinedBuffer() + *getInlinedEntry(3);
+}
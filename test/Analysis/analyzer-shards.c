@@ -0,0 +1,50 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode -analyzer-config shard-count=2,shard-index=0 %s 2> %t.0
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode -analyzer-config shard-count=2,shard-index=1 %s 2> %t.1
+// RUN: cat %t.0 %t.1 | FileCheck %s
+// RUN: cat %t.1 | FileCheck -check-prefix=SHARD1 %s
+// RUN: cat %t.0 %t.1 | grep "analyzer-shards.c:37:" | count 1
+// RUN: not %clang_cc1 -analyze -analyzer-checker=core,deadcode -analyzer-config shard-count=2,shard-index=2 %s 2>&1 | FileCheck -check-prefix=INVALID %s
+// RUN: not %clang_cc1 -analyze -analyzer-checker=core,deadcode -analyzer-config shard-index=1 %s 2>&1 | FileCheck -check-prefix=INVALID %s
+// RUN: not %clang_cc1 -analyze -analyzer-checker=core,deadcode -analyzer-config shard-count=2,shard-index=-1 %s 2>&1 | FileCheck -check-prefix=INVALID %s
+
+// Each root of the call graph is analyzed by exactly one shard, and the
+// functions it calls are inlined by that shard instead of being analyzed as
+// top level by another one. The AST-based checks are only run by the first
+// shard. The index of a shard that does not exist is rejected.
+
+void f1(int *p) {
+  if (p) return;
+  *p = 1;
+}
+
+void f2(int *p) {
+  if (p) return;
+  *p = 2;
+}
+
+void f3(int *p) {
+  if (p) return;
+  *p = 3;
+}
+
+void f4() {
+  int unused;
+  unused = 0;
+}
+
+static void callee(int *p) {
+  if (p) return;
+  *p = 5;
+}
+
+void caller(int *q) {
+  callee(q);
+}
+
+// CHECK-DAG: analyzer-shards.c:17:{{[0-9]+}}: warning: Dereference of null pointer
+// CHECK-DAG: analyzer-shards.c:22:{{[0-9]+}}: warning: Dereference of null pointer
+// CHECK-DAG: analyzer-shards.c:27:{{[0-9]+}}: warning: Dereference of null pointer
+// CHECK-DAG: analyzer-shards.c:32:{{[0-9]+}}: warning: Value stored to 'unused' is never read
+// CHECK-DAG: analyzer-shards.c:37:{{[0-9]+}}: warning: Dereference of null pointer
+// SHARD1-NOT: never read
+// INVALID: error: invalid value '{{-?[0-9]+}}' for analyzer-config option 'shard-index'; expected an index less than 'shard-count'
@@ -0,0 +1,71 @@
+// RUN: rm -f %t.summaries
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,alpha.core.CrossTUSummaries -analyzer-config summary-output=%t.summaries %S/Inputs/cross-tu-summaries-other.c
+// RUN: FileCheck -check-prefix=SUMMARY -input-file=%t.summaries %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection,alpha.core.CrossTUSummaries -analyzer-config summary-input=%t.summaries -verify %s
+
+// SUMMARY-DAG: {{^}}getBuffer nonnull-return{{$}}
+// SUMMARY-DAG: {{^}}findEntry{{$}}
+// SUMMARY-DAG: {{^}}fatal noreturn{{$}}
+// SUMMARY-DAG: {{^}}crash{{$}}
+// SUMMARY-DAG: {{^}}spin noreturn{{$}}
+// SUMMARY-DAG: {{^}}getInlinedBuffer nonnull-return{{$}}
+// SUMMARY-DAG: {{^}}getInlinedEntry{{$}}
+// SUMMARY-DAG: {{^}}inlinedFatal noreturn{{$}}
+// SUMMARY-NOT: getBufferInternal
+
+void clang_analyzer_eval(int);
+
+int *getBuffer(void);
+int *findEntry(int i);
+void fatal(const char *msg);
+void crash(void);
+void spin(void);
+void report(const char *msg);
+int *getInlinedBuffer(void);
+int *getInlinedEntry(int i);
+void inlinedFatal(void);
+
+void testNonNullReturn() {
+  clang_analyzer_eval(getBuffer() != 0); // expected-warning{{TRUE}}
+}
+
+void testMayReturnNull(int i) {
+  clang_analyzer_eval(findEntry(i) != 0); // expected-warning{{UNKNOWN}}
+}
+
+void testNoReturn(int *p) {
+  if (!p)
+    fatal("null pointer");
+  *p = 1; // no-warning
+}
+
+void testNoReturnWithoutSummary(int *p) {
+  if (!p)
+    report("null pointer");
+  *p = 1; // expected-warning{{Dereference of null pointer}}
+}
+
+// Every path of crash() ends in a null dereference, which does not make it
+// noreturn.
+void testAllPathsBuggy(int *p) {
+  if (!p)
+    crash();
+  *p = 1; // expected-warning{{Dereference of null pointer}}
+}
+
+void testInfiniteLoop(int *p) {
+  if (!p)
+    spin();
+  *p = 1; // no-warning
+}
+
+// These functions were only analyzed inlined into their callers. Where it was
+// inlined, getInlinedEntry() was given an index in the buffer and returned an
+// address, but it may return null for other indices.
+void testInlined(int i, int *p) {
+  clang_analyzer_eval(getInlinedBuffer() != 0); // expected-warning{{TRUE}}
+  clang_analyzer_eval(getInlinedEntry(i) != 0); // expected-warning{{UNKNOWN}}
+  if (!p)
+    inlinedFatal();
+  *p = 1; // no-warning
+}
@@ -0,0 +1,45 @@
+// REQUIRES: asserts
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc -analyzer-stats -analyzer-max-loop 4 -analyzer-config max-graph-memory=1 -verify %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc -analyzer-stats -analyzer-max-loop 4 -analyzer-config max-graph-memory=1 %s 2>&1 | FileCheck -check-prefix=REPLAYED %s
+
+// The paths of 'branches' split at every branch, so the exploded graph uses
+// up half of its budget, and then all of it, while 'gives_up' is inlined on
+// some paths. Each time 'gives_up' exhausts the block count, the call is
+// replayed without inlining, which needs the node before the call even when
+// nodes are reclaimed aggressively.
+
+typedef __typeof(sizeof(int)) size_t;
+void *malloc(size_t);
+int cond(int);
+
+static void gives_up(int *x) {
+  for (int i = 0; i < 5; ++i)
+    (*x)++;
+}
+
+void branches(int *x) {
+  if (cond(0)) gives_up(x);
+  if (cond(1)) gives_up(x);
+  if (cond(2)) gives_up(x);
+  if (cond(3)) gives_up(x);
+  if (cond(4)) gives_up(x);
+  if (cond(5)) gives_up(x);
+  if (cond(6)) gives_up(x);
+  if (cond(7)) gives_up(x);
+  if (cond(8)) gives_up(x);
+  if (cond(9)) gives_up(x);
+  if (cond(10)) gives_up(x);
+  if (cond(11)) gives_up(x);
+  if (cond(12)) gives_up(x);
+  if (cond(13)) gives_up(x);
+  if (cond(14)) gives_up(x);
+  if (cond(15)) gives_up(x);
+  char *m = (char *)malloc(12);
+} // expected-warning {{Potential leak of memory pointed to by 'm'}}
+
+// CHECK: ... Statistics Collected ...
+// CHECK-DAG: 1 ExplodedGraph - The # of exploded graphs that used half of their memory budget and switched to aggressive node reclamation
+// CHECK-DAG: ExprEngine - The # of times we re-evaluated a call without inlining
+
+// REPLAYED: ... Statistics Collected ...
+// REPLAYED-NOT: maximum block count in an inlined function
@@ -0,0 +1,39 @@
+// REQUIRES: asserts
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-stats -analyzer-config max-graph-memory=1 %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-stats %s 2>&1 | FileCheck -check-prefix=NO-BUDGET %s
+// RUN: not %clang_cc1 -analyze -analyzer-checker=core -analyzer-config max-graph-memory=-1 %s 2>&1 | FileCheck -check-prefix=INVALID %s
+
+// The paths of this function split at every branch, so its exploded graph
+// uses up a budget of one megabyte long before the node limit is reached.
+
+int cond(int);
+
+int branches(void) {
+  int n = 0;
+  if (cond(0)) ++n;
+  if (cond(1)) ++n;
+  if (cond(2)) ++n;
+  if (cond(3)) ++n;
+  if (cond(4)) ++n;
+  if (cond(5)) ++n;
+  if (cond(6)) ++n;
+  if (cond(7)) ++n;
+  if (cond(8)) ++n;
+  if (cond(9)) ++n;
+  if (cond(10)) ++n;
+  if (cond(11)) ++n;
+  if (cond(12)) ++n;
+  if (cond(13)) ++n;
+  if (cond(14)) ++n;
+  if (cond(15)) ++n;
+  return n;
+}
+
+// CHECK: ... Statistics Collected ...
+// CHECK-DAG: 1 ExplodedGraph - The # of exploded graphs that used half of their memory budget and switched to aggressive node reclamation
+// CHECK-DAG: 1 ExplodedGraph - The # of exploded graphs that used all of their memory budget
+
+// NO-BUDGET: ... Statistics Collected ...
+// NO-BUDGET-NOT: memory budget
+
+// INVALID: error: invalid value '-1' for analyzer-config option 'max-graph-memory'; expected a non-negative number of megabytes
@@ -0,0 +1,26 @@
+// A crash or a fatal error in a frontend job run inside the driver process
+// must not end the driver, which still generates crash diagnostics.
+
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: not env TMPDIR=%t TEMP=%t TMP=%t %clang -fintegrated-cc1 \
+// RUN:   -fsyntax-only -DFATAL %s 2>&1 | FileCheck -check-prefix=FATAL %s
+// RUN: not env TMPDIR=%t TEMP=%t TMP=%t %clang -fintegrated-cc1 \
+// RUN:   -fsyntax-only -DCRASH %s 2>&1 | FileCheck -check-prefix=CRASH %s
+// REQUIRES: crash-recovery
+
+// FATAL: error in backend: #pragma clang __debug llvm_fatal_error
+// FATAL: Preprocessed source(s) and associated run script(s) are located at:
+// FATAL-NEXT: note: diagnostic msg: {{.*}}.c
+
+// CRASH: error: clang frontend command failed due to signal
+// CRASH: Preprocessed source(s) and associated run script(s) are located at:
+// CRASH-NEXT: note: diagnostic msg: {{.*}}.c
+
+#ifdef FATAL
+#pragma clang __debug llvm_fatal_error
+#endif
+
+#ifdef CRASH
+#pragma clang __debug crash
+#endif
@@ -0,0 +1,13 @@
+// The frontend job runs inside the driver process by default; both modes
+// must produce the same result.
+
+// RUN: %clang -fintegrated-cc1 -c %s -o %t.in.o
+// RUN: %clang -fno-integrated-cc1 -c %s -o %t.out.o
+// RUN: cmp %t.in.o %t.out.o
+
+// RUN: %clang -### -fintegrated-cc1 -c %s 2>&1 | FileCheck %s
+// RUN: %clang -### -fno-integrated-cc1 -c %s 2>&1 | FileCheck %s
+// CHECK-NOT: argument unused
+// CHECK: "-cc1"
+
+int f(int x) { return x + 1; }
@@ -0,0 +1,23 @@
+// RUN: sed -e 's/VALUE/1/' %s > %t-1.cpp
+// RUN: sed -e 's/VALUE/2/' %s > %t-2.cpp
+// RUN: sed -e 's/VALUE/3/' %s > %t-3.cpp
+// RUN: clang-format -style=LLVM -j=3 %t-1.cpp %t-2.cpp %t-3.cpp \
+// RUN:   | FileCheck -strict-whitespace %s
+// RUN: clang-format -style=LLVM -j=0 -i %t-1.cpp %t-2.cpp
+// RUN: FileCheck -strict-whitespace -check-prefix=INPLACE -input-file=%t-2.cpp %s
+// RUN: clang-format -style=invalid -fallback-style=LLVM -j=2 %t-1.cpp %t-2.cpp \
+// RUN:   2> %t.err | FileCheck -strict-whitespace -check-prefix=TWO %s
+// RUN: FileCheck -check-prefix=ERRORS -input-file=%t.err %s
+
+// CHECK: {{^int\ k\ =\ 1;}}
+// CHECK: {{^int\ k\ =\ 2;}}
+// CHECK: {{^int\ k\ =\ 3;}}
+// INPLACE: {{^int\ k\ =\ 2;}}
+// TWO: {{^int\ k\ =\ 1;}}
+// TWO: {{^int\ k\ =\ 2;}}
+// The style of the directory is looked up once, but its errors are reported
+// for every file.
+// ERRORS: Invalid value for -style, using LLVM style
+// ERRORS-NEXT: Invalid value for -style, using LLVM style
+// ERRORS-NOT: Invalid
+ int   k   = VALUE ;
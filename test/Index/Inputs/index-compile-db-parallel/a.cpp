@@ -0,0 +1,2 @@
+#include "shared.h"
+int a() { return shared_func(1); }
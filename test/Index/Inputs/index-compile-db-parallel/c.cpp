@@ -0,0 +1,2 @@
+#include "shared.h"
+int c() { return shared_func(3); }
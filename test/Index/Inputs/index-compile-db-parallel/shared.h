@@ -0,0 +1,8 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+inline int shared_helper(int x) { return x + 1; }
+
+inline int shared_func(int x) { return shared_helper(x) * 2; }
+
+#endif
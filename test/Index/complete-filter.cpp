@@ -0,0 +1,26 @@
+struct S {
+  int getNextValue();
+  int gotoNext();
+  int getValue();
+  int genvalue;
+  int other;
+};
+
+void test(S s) {
+  s.getNextValue();
+}
+
+// RUN: env CINDEXTEST_COMPLETION_FILTER=gNV c-index-test -code-completion-at=%s:10:5 %s | FileCheck -check-prefix=CHECK-FUZZY %s
+// CHECK-FUZZY-NOT: TypedText gotoNext
+// CHECK-FUZZY-NOT: TypedText getValue
+// CHECK-FUZZY: CXXMethod:{ResultType int}{TypedText getNextValue}{LeftParen (}{RightParen )} (34)
+// CHECK-FUZZY-NEXT: FieldDecl:{ResultType int}{TypedText genvalue} (35)
+// CHECK-FUZZY-NOT: TypedText other
+// CHECK-FUZZY: Completion contexts:
+
+// RUN: env CINDEXTEST_COMPLETION_FILTER=get c-index-test -code-completion-at=%s:10:5 %s | FileCheck -check-prefix=CHECK-PREFIX %s
+// CHECK-PREFIX: CXXMethod:{ResultType int}{TypedText getNextValue}{LeftParen (}{RightParen )} (34)
+// CHECK-PREFIX-NEXT: CXXMethod:{ResultType int}{TypedText getValue}{LeftParen (}{RightParen )} (34)
+// CHECK-PREFIX-NEXT: CXXMethod:{ResultType int}{TypedText gotoNext}{LeftParen (}{RightParen )} (34)
+// CHECK-PREFIX-NOT: TypedText genvalue
+// CHECK-PREFIX: Completion contexts:
@@ -0,0 +1,26 @@
+// The compile commands refer to their files relative to their directory,
+// which is not the working directory of c-index-test.
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/db
+// RUN: sed -e "s:INPUT_DIR:%S/Inputs/index-compile-db-parallel:g" \
+// RUN:   %S/Inputs/index-compile-db-parallel/compile_commands.json \
+// RUN:   > %t/db/compile_commands.json
+// RUN: cd %t && c-index-test -index-compile-db-parallel 2 \
+// RUN:   %t/db/compile_commands.json > %t/out2
+// RUN: FileCheck %s < %t/out2
+// RUN: cd %t && c-index-test -index-compile-db-parallel 1 \
+// RUN:   %t/db/compile_commands.json > %t/out1
+// RUN: FileCheck %s < %t/out1
+
+// The body of shared_func is only parsed, and its references reported, by
+// one of the translation units.
+// RUN: grep "shared_helper | .*shared.h:6" %t/out2 | count 1
+// RUN: grep "shared_helper | .*shared.h:6" %t/out1 | count 1
+// XFAIL: mingw32,win32
+
+// CHECK-DAG: [indexEntityReference]: shared_func | {{.*}}a.cpp:2
+// CHECK-DAG: [indexEntityReference]: shared_func | {{.*}}b.cpp:2
+// CHECK-DAG: [indexEntityReference]: shared_func | {{.*}}c.cpp:2
+// CHECK-DAG: [indexProgress]: 1/3 | result: 0
+// CHECK-DAG: [indexProgress]: 2/3 | result: 0
+// CHECK-DAG: [indexProgress]: 3/3 | result: 0
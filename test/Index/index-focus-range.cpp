@@ -0,0 +1,29 @@
+int some_val;
+
+void before() {
+  some_val = 1;
+}
+
+struct S {
+  S() : x{0}, y{1} {
+    some_val = 2;
+  }
+  int x, y;
+};
+
+void after() {
+  some_val = 3;
+}
+
+// RUN: env CINDEXTEST_FOCUS_LINES=9:9 c-index-test -index-file %s -std=c++11 | FileCheck %s
+// CHECK:      [indexDeclaration]: kind: function | name: before | {{.*}} | isDef: 1 | isContainer: skipped
+// CHECK-NOT:  loc: {{.*}}:4:3
+// CHECK:      [indexDeclaration]: kind: constructor | name: S | {{.*}} | isDef: 1 | isContainer: 1
+// CHECK:      [indexEntityReference]: kind: variable | name: some_val | {{.*}} | loc: {{.*}}:9:5
+// CHECK:      [indexDeclaration]: kind: function | name: after | {{.*}} | isDef: 1 | isContainer: skipped
+// CHECK-NOT:  loc: {{.*}}:15:3
+
+// RUN: env CINDEXTEST_FOCUS_LINES=4:4 c-index-test -index-file %s -std=c++11 | FileCheck %s -check-prefix=BEFORE
+// BEFORE:      [indexDeclaration]: kind: function | name: before | {{.*}} | isDef: 1 | isContainer: 1
+// BEFORE:      [indexDeclaration]: kind: constructor | name: S | {{.*}} | isDef: 1 | isContainer: skipped
+// BEFORE:      [indexDeclaration]: kind: function | name: after | {{.*}} | isDef: 1 | isContainer: skipped
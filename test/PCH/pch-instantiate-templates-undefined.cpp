@@ -0,0 +1,36 @@
+// Instantiations the header requires from templates that are only defined by
+// the translation unit are left pending in the PCH, and performed at the end
+// of the translation unit as without -fpch-instantiate-templates.
+// RUN: %clang_cc1 -std=c++1y -x c++-header -fpch-instantiate-templates \
+// RUN:   -emit-pch %s -o %t
+// RUN: %clang_cc1 -std=c++1y -triple x86_64-unknown-unknown -include-pch %t \
+// RUN:   -emit-llvm %s -o - | FileCheck %s
+
+// CHECK-DAG: @_ZN6HolderIiE5ValueE = linkonce_odr global i32
+// CHECK-DAG: @_Z11varTemplateIiE = linkonce_odr global i32
+// CHECK-DAG: define linkonce_odr i32 @_Z5laterIiET_S0_(
+
+#ifndef HEADER_INCLUDED
+#define HEADER_INCLUDED
+
+template <typename T> T later(T t);
+
+template <typename T> struct Holder {
+  static T Value;
+};
+
+template <typename T> extern T varTemplate;
+
+inline int use() { return later(1) + Holder<int>::Value + varTemplate<int>; }
+
+#else
+
+template <typename T> T later(T t) { return t; }
+
+template <typename T> T Holder<T>::Value = T(2);
+
+template <typename T> T varTemplate = T(3);
+
+int main() { return use(); }
+
+#endif
@@ -0,0 +1,43 @@
+// Without -fpch-instantiate-templates, the instantiations the header requires
+// are performed in the translation unit.
+// RUN: %clang_cc1 -x c++-header -emit-pch %s -o %t
+// RUN: %clang_cc1 -include-pch %t -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-TU %s
+
+// With it, they are performed while building the PCH, and reused.
+// RUN: %clang_cc1 -x c++-header -fpch-instantiate-templates -emit-pch %s \
+// RUN:   -o %t.inst
+// RUN: %clang_cc1 -include-pch %t.inst -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-PCH %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.inst \
+// RUN:   -emit-llvm %s -o - | FileCheck -check-prefix=CHECK-IR %s
+
+// CHECK-TU: 2 pending implicit instantiations processed.
+// CHECK-PCH: 0 pending implicit instantiations processed.
+
+// CHECK-IR-DAG: define linkonce_odr i32 @_Z5twiceIiET_S0_(
+// CHECK-IR-DAG: define linkonce_odr i32 @_ZN3BoxIiE3getEv(
+
+#ifndef HEADER_INCLUDED
+#define HEADER_INCLUDED
+
+template <typename T> T twice(T t) { return T(2) * t; }
+
+template <typename T> struct Box {
+  T Value;
+  T get();
+};
+
+template <typename T> T Box<T>::get() { return Value; }
+
+inline int use(Box<int> B) { return twice(B.get()); }
+
+#else
+
+int main() {
+  Box<int> B;
+  B.Value = 21;
+  return use(B);
+}
+
+#endif
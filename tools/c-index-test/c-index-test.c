@@ -2060,7 +2060,23 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
     enum CXCursorKind containerKind;
     CXString objCSelector;
     const char *selectorString;
-    if (!timing_only) {      
+    if (!timing_only && getenv("CINDEXTEST_COMPLETION_FILTER")) {
+      /* Filter as if the filter text was typed one character at a time, and
+         print the matches in rank order. */
+      const char *filter = getenv("CINDEXTEST_COMPLETION_FILTER");
+      size_t len = strlen(filter), j;
+      char *typed = (char *)malloc(len + 1);
+      for (j = 0; j <= len; ++j) {
+        memcpy(typed, filter, j);
+        typed[j] = 0;
+        n = clang_codeCompleteFilterResults(results, typed);
+      }
+      free(typed);
+      for (i = 0; i != n; ++i)
+        print_completion_result(
+            results->Results + clang_codeCompleteGetFilteredResult(results, i),
+            stdout);
+    } else if (!timing_only) {      
       /* Sort the code-completion results based on the typed text. */
       clang_sortCodeCompletionResults(results->Results, results->NumResults);
 
@@ -3117,6 +3133,17 @@ static int index_file(int argc, const char **argv, int full) {
     return 1;
   }
   idxAction = clang_IndexAction_create(Idx);
+  if (getenv("CINDEXTEST_FOCUS_LINES")) {
+    unsigned start_line = 0, end_line = 0;
+    if (sscanf(getenv("CINDEXTEST_FOCUS_LINES"), "%u:%u",
+               &start_line, &end_line) != 2) {
+      fprintf(stderr, "invalid CINDEXTEST_FOCUS_LINES\n");
+      clang_IndexAction_dispose(idxAction);
+      clang_disposeIndex(Idx);
+      return 1;
+    }
+    clang_IndexAction_setFocusRange(idxAction, start_line, end_line);
+  }
   importedASTs = 0;
   if (full)
     importedASTs = importedASTs_create();
@@ -3293,6 +3320,84 @@ static int index_compile_db(int argc, const char **argv) {
   return errorCode;
 }
 
+static void index_compile_db_progress(CXClientData client_data,
+                                      const char *source_filename,
+                                      unsigned num_indexed,
+                                      unsigned num_total,
+                                      int result) {
+  /* The order in which files complete is not deterministic. */
+  printf("[indexProgress]: %u/%u | result: %d\n", num_indexed, num_total,
+         result);
+}
+
+/* Prints a reference with a single call, since the references of different
+   translation units are reported concurrently. */
+static void index_compile_db_reference(CXClientData client_data,
+                                       const CXIdxEntityRefInfo *info) {
+  CXFile file;
+  CXString filename;
+  unsigned line;
+
+  if (!info->referencedEntity || !info->referencedEntity->name)
+    return;
+  clang_indexLoc_getFileLocation(info->loc, 0, &file, &line, 0, 0);
+  filename = clang_getFileName(file);
+  printf("[indexEntityReference]: %s | %s:%u\n", info->referencedEntity->name,
+         clang_getCString(filename), line);
+  clang_disposeString(filename);
+}
+
+static int index_compile_db_parallel(int argc, const char **argv) {
+  CXIndex Idx;
+  CXIndexAction idxAction;
+  CXCompilationDatabase db;
+  CXCompilationDatabase_Error ec;
+  IndexerCallbacks callbacks;
+  unsigned num_threads;
+  char *tmp;
+  unsigned len;
+  int errorCode;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: -index-compile-db-parallel <threads> <database>\n");
+    return -1;
+  }
+  num_threads = (unsigned)atoi(argv[0]);
+
+  len = strlen(argv[1]);
+  tmp = (char *) malloc(len+1);
+  memcpy(tmp, argv[1], len+1);
+  db = clang_CompilationDatabase_fromDirectory(dirname(tmp), &ec);
+  free(tmp);
+  if (!db) {
+    printf("database loading failed with error code %d.\n", ec);
+    return -1;
+  }
+
+  if (!(Idx = clang_createIndex(/* excludeDeclsFromPCH */ 1,
+                                /* displayDiagnostics=*/1))) {
+    fprintf(stderr, "Could not create Index\n");
+    clang_CompilationDatabase_dispose(db);
+    return 1;
+  }
+  idxAction = clang_IndexAction_create(Idx);
+
+  memset(&callbacks, 0, sizeof(callbacks));
+  callbacks.indexEntityReference = index_compile_db_reference;
+  errorCode = clang_indexCompilationDatabase(idxAction, 0, &callbacks,
+                                             sizeof(callbacks),
+                                             getIndexOptions(), db,
+                                             num_threads,
+                                             index_compile_db_progress);
+  if (errorCode != CXError_Success)
+    describeLibclangFailure(errorCode);
+
+  clang_IndexAction_dispose(idxAction);
+  clang_disposeIndex(Idx);
+  clang_CompilationDatabase_dispose(db);
+  return errorCode;
+}
+
 int perform_token_annotation(int argc, const char **argv) {
   const char *input = argv[1];
   char *filename = 0;
@@ -3964,6 +4069,7 @@ static void print_usage(void) {
     "       c-index-test -index-file-full [-check-prefix=<FileCheck prefix>] <compiler arguments>\n"
     "       c-index-test -index-tu [-check-prefix=<FileCheck prefix>] <AST file>\n"
     "       c-index-test -index-compile-db [-check-prefix=<FileCheck prefix>] <compilation database>\n"
+    "       c-index-test -index-compile-db-parallel <threads> <compilation database>\n"
     "       c-index-test -test-file-scan <AST file> <source file> "
           "[FileCheck prefix]\n");
   fprintf(stderr,
@@ -4033,6 +4139,8 @@ int cindextest_main(int argc, const char **argv) {
     return index_tu(argc - 2, argv + 2);
   if (argc > 2 && strcmp(argv[1], "-index-compile-db") == 0)
     return index_compile_db(argc - 2, argv + 2);
+  if (argc > 2 && strcmp(argv[1], "-index-compile-db-parallel") == 0)
+    return index_compile_db_parallel(argc - 2, argv + 2);
   else if (argc >= 4 && strncmp(argv[1], "-test-load-tu", 13) == 0) {
     CXCursorVisitor I = GetVisitor(argv[1] + 13);
     if (I)
@@ -18,13 +18,18 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/Version.h"
+#include "clang/Basic/WorkerThreads.h"
 #include "clang/Format/Format.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
+#include <atomic>
 
 using namespace llvm;
 
@@ -96,6 +101,19 @@ static cl::opt<unsigned>
            cl::desc("The position of the cursor when invoking\n"
                     "clang-format from an editor integration"),
            cl::init(0), cl::cat(ClangFormatCategory));
+static cl::opt<std::string>
+    CacheFile("cache",
+              cl::desc("File remembering how lines were formatted, so that\n"
+                       "lines which did not change since the last run are\n"
+                       "formatted without searching for their formatting\n"
+                       "again. Created if it does not exist."),
+              cl::cat(ClangFormatCategory));
+static cl::opt<unsigned>
+    NumThreads("j",
+               cl::desc("Number of files to format concurrently. 0 uses\n"
+                        "all hardware threads. Output is written in the\n"
+                        "order the files are given."),
+               cl::init(1), cl::cat(ClangFormatCategory));
 
 static cl::list<std::string> FileNames(cl::Positional, cl::desc("[<file> ...]"),
                                        cl::cat(ClangFormatCategory));
@@ -149,27 +167,29 @@ static bool fillRanges(SourceManager &Sources, FileID ID,
     return false;
   }
 
-  if (Offsets.empty())
-    Offsets.push_back(0);
-  if (Offsets.size() != Lengths.size() &&
-      !(Offsets.size() == 1 && Lengths.empty())) {
+  // Files may be formatted concurrently, so leave the option untouched.
+  std::vector<unsigned> FileOffsets(Offsets.begin(), Offsets.end());
+  if (FileOffsets.empty())
+    FileOffsets.push_back(0);
+  if (FileOffsets.size() != Lengths.size() &&
+      !(FileOffsets.size() == 1 && Lengths.empty())) {
     llvm::errs()
         << "error: number of -offset and -length arguments must match.\n";
     return true;
   }
-  for (unsigned i = 0, e = Offsets.size(); i != e; ++i) {
-    if (Offsets[i] >= Code->getBufferSize()) {
-      llvm::errs() << "error: offset " << Offsets[i]
+  for (unsigned i = 0, e = FileOffsets.size(); i != e; ++i) {
+    if (FileOffsets[i] >= Code->getBufferSize()) {
+      llvm::errs() << "error: offset " << FileOffsets[i]
                    << " is outside the file\n";
       return true;
     }
     SourceLocation Start =
-        Sources.getLocForStartOfFile(ID).getLocWithOffset(Offsets[i]);
+        Sources.getLocForStartOfFile(ID).getLocWithOffset(FileOffsets[i]);
     SourceLocation End;
     if (i < Lengths.size()) {
-      if (Offsets[i] + Lengths[i] > Code->getBufferSize()) {
+      if (FileOffsets[i] + Lengths[i] > Code->getBufferSize()) {
         llvm::errs() << "error: invalid length " << Lengths[i]
-                     << ", offset + length (" << Offsets[i] + Lengths[i]
+                     << ", offset + length (" << FileOffsets[i] + Lengths[i]
                      << ") is outside the file.\n";
         return true;
       }
@@ -182,28 +202,67 @@ static bool fillRanges(SourceManager &Sources, FileID ID,
   return false;
 }
 
-static void outputReplacementXML(StringRef Text) {
+static void outputReplacementXML(StringRef Text, raw_ostream &OS) {
   size_t From = 0;
   size_t Index;
   while ((Index = Text.find_first_of("\n\r", From)) != StringRef::npos) {
-    llvm::outs() << Text.substr(From, Index - From);
+    OS << Text.substr(From, Index - From);
     switch (Text[Index]) {
     case '\n':
-      llvm::outs() << "&#10;";
+      OS << "&#10;";
       break;
     case '\r':
-      llvm::outs() << "&#13;";
+      OS << "&#13;";
       break;
     default:
       llvm_unreachable("Unexpected character encountered!");
     }
     From = Index + 1;
   }
-  llvm::outs() << Text.substr(From);
+  OS << Text.substr(From);
 }
 
-// Returns true on error.
-static bool format(StringRef FileName) {
+namespace {
+// Remembers the styles found for the files of a directory, so that the
+// .clang-format files are only read and parsed once per directory.
+class StyleCache {
+public:
+  // Returns the style of \p FileName, writing the errors found while looking
+  // it up to \p Errs, for every file of the directory.
+  FormatStyle getStyle(StringRef FileName, raw_ostream &Errs) {
+    // Besides the directory, the style depends on the language, which is
+    // determined by the file extension.
+    SmallString<128> Path(FileName);
+    llvm::sys::fs::make_absolute(Path);
+    std::string Key = llvm::sys::path::parent_path(Path).str() + '\0' +
+                      llvm::sys::path::extension(Path).lower();
+
+    llvm::MutexGuard Guard(Lock);
+    bool Found = Styles.count(Key);
+    CachedStyle &Cached = Styles[Key];
+    if (!Found) {
+      llvm::raw_string_ostream OS(Cached.Errors);
+      Cached.Style = format::getStyle(Style, FileName, FallbackStyle, OS);
+    }
+    Errs << Cached.Errors;
+    return Cached.Style;
+  }
+
+private:
+  struct CachedStyle {
+    FormatStyle Style;
+    std::string Errors;
+  };
+
+  llvm::sys::Mutex Lock;
+  llvm::StringMap<CachedStyle> Styles;
+};
+} // end anonymous namespace
+
+// Formats \p FileName, writing the result to \p OS unless formatting in
+// place, and errors to \p Errs. Returns true on error.
+static bool format(StringRef FileName, FormattingCache *Cache,
+                   StyleCache &Styles, raw_ostream &OS, raw_ostream &Errs) {
   FileManager Files((FileSystemOptions()));
   DiagnosticsEngine Diagnostics(
       IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
@@ -212,7 +271,7 @@ static bool format(StringRef FileName) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
       MemoryBuffer::getFileOrSTDIN(FileName);
   if (std::error_code EC = CodeOrErr.getError()) {
-    llvm::errs() << EC.message() << "\n";
+    Errs << EC.message() << "\n";
     return true;
   }
   std::unique_ptr<llvm::MemoryBuffer> Code = std::move(CodeOrErr.get());
@@ -223,24 +282,24 @@ static bool format(StringRef FileName) {
   if (fillRanges(Sources, ID, Code.get(), Ranges))
     return true;
 
-  FormatStyle FormatStyle = getStyle(
-      Style, (FileName == "-") ? AssumeFilename : FileName, FallbackStyle);
+  FormatStyle FormatStyle =
+      Styles.getStyle((FileName == "-") ? AssumeFilename : FileName, Errs);
   Lexer Lex(ID, Sources.getBuffer(ID), Sources,
             getFormattingLangOpts(FormatStyle.Standard));
-  tooling::Replacements Replaces = reformat(FormatStyle, Lex, Sources, Ranges);
+  tooling::Replacements Replaces =
+      reformat(FormatStyle, Lex, Sources, Ranges, Cache);
   if (OutputXML) {
-    llvm::outs()
-        << "<?xml version='1.0'?>\n<replacements xml:space='preserve'>\n";
+    OS << "<?xml version='1.0'?>\n<replacements xml:space='preserve'>\n";
     for (tooling::Replacements::const_iterator I = Replaces.begin(),
                                                E = Replaces.end();
          I != E; ++I) {
-      llvm::outs() << "<replacement "
-                   << "offset='" << I->getOffset() << "' "
-                   << "length='" << I->getLength() << "'>";
-      outputReplacementXML(I->getReplacementText());
-      llvm::outs() << "</replacement>\n";
+      OS << "<replacement "
+         << "offset='" << I->getOffset() << "' "
+         << "length='" << I->getLength() << "'>";
+      outputReplacementXML(I->getReplacementText(), OS);
+      OS << "</replacement>\n";
     }
-    llvm::outs() << "</replacements>\n";
+    OS << "</replacements>\n";
   } else {
     Rewriter Rewrite(Sources, LangOptions());
     tooling::applyAllReplacements(Replaces, Rewrite);
@@ -249,14 +308,65 @@ static bool format(StringRef FileName) {
         return true;
     } else {
       if (Cursor.getNumOccurrences() != 0)
-        outs() << "{ \"Cursor\": "
-               << tooling::shiftedCodePosition(Replaces, Cursor) << " }\n";
-      Rewrite.getEditBuffer(ID).write(outs());
+        OS << "{ \"Cursor\": "
+           << tooling::shiftedCodePosition(Replaces, Cursor) << " }\n";
+      Rewrite.getEditBuffer(ID).write(OS);
     }
   }
   return false;
 }
 
+// Formats \p FileNames on up to \p NumThreads threads. The output and errors
+// of each file are buffered and written in the order of \p FileNames as soon
+// as the preceding files are done. Returns true on error.
+static bool formatInParallel(ArrayRef<std::string> FileNames,
+                             FormattingCache *Cache, StyleCache &Styles,
+                             unsigned NumThreads) {
+  struct FileResult {
+    FileResult() : Done(false) {}
+    std::string Output;
+    std::string Errors;
+    bool Done;
+  };
+  std::vector<FileResult> Results(FileNames.size());
+  std::atomic<unsigned> NextFile(0);
+  std::atomic<bool> Error(false);
+  // Guards Results[].Done, NextToPrint and the output streams.
+  llvm::sys::Mutex OutputMux;
+  unsigned NextToPrint = 0;
+
+  auto FormatFiles = [&]() {
+    while (true) {
+      unsigned I = NextFile++;
+      if (I >= FileNames.size())
+        return;
+      FileResult &Result = Results[I];
+      {
+        llvm::raw_string_ostream OS(Result.Output);
+        llvm::raw_string_ostream Errs(Result.Errors);
+        if (format(FileNames[I], Cache, Styles, OS, Errs))
+          Error = true;
+      }
+
+      llvm::MutexGuard Guard(OutputMux);
+      Result.Done = true;
+      for (; NextToPrint < Results.size() && Results[NextToPrint].Done;
+           ++NextToPrint) {
+        FileResult &Next = Results[NextToPrint];
+        llvm::errs() << Next.Errors;
+        llvm::outs() << Next.Output;
+        // Release the memory of files already written.
+        std::string().swap(Next.Output);
+        std::string().swap(Next.Errors);
+      }
+    }
+  };
+
+  runOnWorkerThreads(FormatFiles, NumThreads, FileNames.size());
+
+  return Error;
+}
+
 }  // namespace format
 }  // namespace clang
 
@@ -300,13 +410,22 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
+  clang::format::FormattingCache FormattingCache;
+  clang::format::FormattingCache *Cache = nullptr;
+  if (!CacheFile.empty()) {
+    // A missing or outdated cache file is simply rebuilt.
+    FormattingCache.load(CacheFile);
+    Cache = &FormattingCache;
+  }
+
+  clang::format::StyleCache Styles;
   bool Error = false;
   switch (FileNames.size()) {
   case 0:
-    Error = clang::format::format("-");
+    Error = clang::format::format("-", Cache, Styles, outs(), errs());
     break;
   case 1:
-    Error = clang::format::format(FileNames[0]);
+    Error = clang::format::format(FileNames[0], Cache, Styles, outs(), errs());
     break;
   default:
     if (!Offsets.empty() || !Lengths.empty() || !LineRanges.empty()) {
@@ -314,9 +433,19 @@ int main(int argc, const char **argv) {
                       "single file.\n";
       return 1;
     }
-    for (unsigned i = 0; i < FileNames.size(); ++i)
-      Error |= clang::format::format(FileNames[i]);
+    if (NumThreads == 1) {
+      for (unsigned i = 0; i < FileNames.size(); ++i)
+        Error |= clang::format::format(FileNames[i], Cache, Styles, outs(),
+                                       errs());
+    } else {
+      Error = clang::format::formatInParallel(FileNames, Cache, Styles,
+                                              NumThreads);
+    }
     break;
   }
+  if (Cache && !Cache->save(CacheFile)) {
+    llvm::errs() << "error: cannot write cache file " << CacheFile << "\n";
+    Error = true;
+  }
   return Error ? 1 : 0;
 }
@@ -27,6 +27,7 @@
 #include "llvm/LinkAllPasses.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Signals.h"
@@ -41,6 +42,16 @@ using namespace llvm::opt;
 // Main driver
 //===----------------------------------------------------------------------===//
 
+/// The exit status of the last frontend run inside the driver process that
+/// ended with a fatal error.
+int cc1_fatal_error_status = 0;
+
+/// Returns true if the frontend runs inside the driver process, in which case
+/// it must neither exit nor shut down LLVM.
+static bool isRunningInDriver() {
+  return llvm::CrashRecoveryContext::GetCurrent() != nullptr;
+}
+
 static void LLVMErrorHandler(void *UserData, const std::string &Message,
                              bool GenCrashDiag) {
   DiagnosticsEngine &Diags = *static_cast<DiagnosticsEngine*>(UserData);
@@ -54,7 +65,16 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
   // We cannot recover from llvm errors.  When reporting a fatal error, exit
   // with status 70 to generate crash diagnostics.  For BSD systems this is
   // defined as an internal software error.  Otherwise, exit with status 1.
-  exit(GenCrashDiag ? 70 : 1);
+  int Status = GenCrashDiag ? 70 : 1;
+
+  // Inside the driver, exiting would also skip its crash diagnostics, the
+  // removal of its temporary files and its remaining jobs. Unwind back to it
+  // instead.
+  if (isRunningInDriver()) {
+    cc1_fatal_error_status = Status;
+    llvm::CrashRecoveryContext::GetCurrent()->HandleCrash();
+  }
+  exit(Status);
 }
 
 #ifdef LINK_POLLY_INTO_TOOLS
@@ -128,6 +148,14 @@ int cc1_main(const char **ArgBegin, const char **ArgEnd,
     return !Success;
   }
 
+  // The driver still uses the managed statics when the frontend runs inside
+  // it; it shuts them down itself.
+  if (isRunningInDriver()) {
+    if (llvm::AreStatisticsEnabled() || Clang->getFrontendOpts().ShowStats)
+      llvm::PrintStatistics();
+    return !Success;
+  }
+
   // Managed static deconstruction. Useful for making things like
   // -time-passes usable.
   llvm::llvm_shutdown();
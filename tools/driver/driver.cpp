@@ -30,6 +30,7 @@
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
@@ -191,6 +192,43 @@ extern int cc1_main(const char **ArgBegin, const char **ArgEnd,
                     const char *Argv0, void *MainAddr);
 extern int cc1as_main(const char **ArgBegin, const char **ArgEnd,
                       const char *Argv0, void *MainAddr);
+extern int cc1_fatal_error_status;
+
+/// ExecuteCC1Tool - Run the -cc1 integrated tool named by argv[1]. This is
+/// used both for explicit -cc1 invocations and, through Driver::CC1Main, for
+/// frontend jobs run inside the driver process.
+static int ExecuteCC1Tool(ArrayRef<const char *> argv) {
+  StringRef Tool = argv[1] + 4;
+
+  if (Tool == "")
+    return cc1_main(argv.data()+2, argv.data()+argv.size(), argv[0],
+                    (void*) (intptr_t) GetExecutablePath);
+  if (Tool == "as")
+    return cc1as_main(argv.data()+2, argv.data()+argv.size(), argv[0],
+                    (void*) (intptr_t) GetExecutablePath);
+
+  // Reject unknown tools.
+  llvm::errs() << "error: unknown integrated tool '" << Tool << "'\n";
+  return 1;
+}
+
+/// ExecuteCC1ToolInProcess - Run a frontend job of the driver inside its
+/// process. A crash unwinds back here and is reported like a signalled child
+/// process would be; a fatal error is reported with the status the frontend
+/// would have exited with.
+static int ExecuteCC1ToolInProcess(ArrayRef<const char *> argv) {
+  llvm::CrashRecoveryContext::Enable();
+  llvm::CrashRecoveryContext CRC;
+  int Res = 0;
+  cc1_fatal_error_status = 0;
+  if (!CRC.RunSafely([&]() { Res = ExecuteCC1Tool(argv); })) {
+    // The frontend did not get to uninstall its error handler, which refers to
+    // its diagnostics.
+    llvm::remove_fatal_error_handler();
+    return cc1_fatal_error_status ? cc1_fatal_error_status : -1;
+  }
+  return Res;
+}
 
 static void ParseProgName(SmallVectorImpl<const char *> &ArgVector,
                           std::set<std::string> &SavedStrings,
@@ -311,20 +349,8 @@ int main(int argc_, const char **argv_) {
   llvm::cl::ExpandResponseFiles(Saver, llvm::cl::TokenizeGNUCommandLine, argv);
 
   // Handle -cc1 integrated tools.
-  if (argv.size() > 1 && StringRef(argv[1]).startswith("-cc1")) {
-    StringRef Tool = argv[1] + 4;
-
-    if (Tool == "")
-      return cc1_main(argv.data()+2, argv.data()+argv.size(), argv[0],
-                      (void*) (intptr_t) GetExecutablePath);
-    if (Tool == "as")
-      return cc1as_main(argv.data()+2, argv.data()+argv.size(), argv[0],
-                      (void*) (intptr_t) GetExecutablePath);
-
-    // Reject unknown tools.
-    llvm::errs() << "error: unknown integrated tool '" << Tool << "'\n";
-    return 1;
-  }
+  if (argv.size() > 1 && StringRef(argv[1]).startswith("-cc1"))
+    return ExecuteCC1Tool(argv);
 
   bool CanonicalPrefixes = true;
   for (int i = 1, size = argv.size(); i < size; ++i) {
@@ -372,6 +398,7 @@ int main(int argc_, const char **argv_) {
   ProcessWarningOptions(Diags, *DiagOpts, /*ReportDiags=*/false);
 
   Driver TheDriver(Path, llvm::sys::getDefaultTargetTriple(), Diags);
+  TheDriver.CC1Main = &ExecuteCC1ToolInProcess;
 
   // Attempt to find the original path used to invoke the driver, to determine
   // the installed path. We do this manually, because we want to support that
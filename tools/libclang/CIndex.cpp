@@ -20,6 +20,7 @@
 #include "CXString.h"
 #include "CXTranslationUnit.h"
 #include "CXType.h"
+#include "CXUSRTable.h"
 #include "CursorVisitor.h"
 #include "clang/AST/Attr.h"
 #include "clang/AST/StmtVisitor.h"
@@ -79,6 +80,8 @@ CXTranslationUnit cxtu::MakeCXTranslationUnit(CIndexer *CIdx, ASTUnit *AU) {
     D->Diagnostics = nullptr;
     D->OverridenCursorsPool = createOverridenCXCursorsPool();
     D->CommentToXML = nullptr;
+    D->USRs = nullptr;
+    D->DeclUSRs = nullptr;
     return D;
 }
 
@@ -3451,6 +3454,8 @@ void clang_disposeTranslationUnit(CXTranslationUnit CTUnit) {
         delete static_cast<CXDiagnosticSetImpl *>(CTUnit->Diagnostics);
         disposeOverridenCXCursorsPool(CTUnit->OverridenCursorsPool);
         delete CTUnit->CommentToXML;
+        delete CTUnit->DeclUSRs;
+        delete CTUnit->USRs;
         delete CTUnit;
     }
 }
@@ -3484,6 +3489,14 @@ static void clang_reparseTranslationUnit_Impl(void *UserData) {
     delete static_cast<CXDiagnosticSetImpl *>(TU->Diagnostics);
     TU->Diagnostics = nullptr;
 
+    // The memoized USRs refer to the old declarations. Drop the interned
+    // strings along with them, so that the table doesn't grow with every
+    // reparse.
+    delete TU->DeclUSRs;
+    TU->DeclUSRs = nullptr;
+    delete TU->USRs;
+    TU->USRs = nullptr;
+
     CIndexer *CXXIdx = TU->CIdx;
     if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForEditing))
         setThreadBackgroundPriority();
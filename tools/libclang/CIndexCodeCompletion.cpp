@@ -21,6 +21,7 @@
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/Type.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/ASTUnit.h"
@@ -241,6 +242,19 @@ clang_getCompletionBriefComment(CXCompletionString completion_string) {
 
 namespace {
 
+/// \brief A code-completion result that matched the filter passed to
+/// clang_codeCompleteFilterResults.
+struct FilteredCompletionResult {
+  /// \brief The index of the result in CXCodeCompleteResults::Results.
+  unsigned Index;
+
+  /// \brief How well the result matched the filter; higher is better.
+  unsigned Score;
+
+  /// \brief The priority of the result; lower is better.
+  unsigned Priority;
+};
+
 /// \brief The CXCodeCompleteResults structure we allocate internally;
 /// the client only sees the initial CXCodeCompleteResults structure.
 ///
@@ -308,6 +322,24 @@ struct AllocatedCXCodeCompleteResults : public CXCodeCompleteResults {
   /// \brief A string containing the Objective-C selector entered thus far for a
   /// message send.
   std::string Selector;
+
+  /// \brief The typed text of each result, computed when the results are
+  /// first filtered.
+  std::vector<std::string> TypedTexts;
+
+  /// \brief Whether the results have been filtered.
+  bool IsFiltered;
+
+  /// \brief The filter passed to the last call to
+  /// clang_codeCompleteFilterResults.
+  std::string Filter;
+
+  /// \brief The results matching \c Filter. The first \c NumRanked of them
+  /// are the best matches, in order; the rest are ranked on demand.
+  std::vector<FilteredCompletionResult> FilteredResults;
+
+  /// \brief The number of results in \c FilteredResults that are ranked.
+  unsigned NumRanked;
 };
 
 } // end anonymous namespace
@@ -327,7 +359,8 @@ AllocatedCXCodeCompleteResults::AllocatedCXCodeCompleteResults(
       FileMgr(FileMgr), SourceMgr(new SourceManager(*Diag, *FileMgr)),
       CodeCompletionAllocator(new clang::GlobalCodeCompletionAllocator),
       Contexts(CXCompletionContext_Unknown),
-      ContainerKind(CXCursor_InvalidCode), ContainerIsIncomplete(1) {
+      ContainerKind(CXCursor_InvalidCode), ContainerIsIncomplete(1),
+      IsFiltered(false), NumRanked(0) {
   if (getenv("LIBCLANG_OBJTRACKING"))
     fprintf(stderr, "+++ %u completion results\n",
             ++CodeCompletionResultObjects);
@@ -1005,3 +1038,144 @@ extern "C" {
     std::stable_sort(Results, Results + NumResults, OrderCompletionResults());
   }
 }
+
+/// \brief Score how well \p Text matches \p Filter, ignoring case.
+///
+/// The characters of \p Filter have to appear in \p Text in order; matches at
+/// the start of a word, consecutive matches, matches with the same case and
+/// prefix matches score higher.
+///
+/// \returns 0 if \p Text does not match \p Filter.
+static unsigned scoreFuzzyMatch(StringRef Text, StringRef Filter) {
+  if (Filter.empty())
+    return 1;
+  if (Filter.size() > Text.size())
+    return 0;
+
+  unsigned Score = 1;
+  size_t Pos = 0;
+  size_t LastMatch = StringRef::npos;
+  for (size_t I = 0, N = Filter.size(); I != N; ++I) {
+    char Lower = toLowercase(Filter[I]);
+    while (Pos != Text.size() && toLowercase(Text[Pos]) != Lower)
+      ++Pos;
+    if (Pos == Text.size())
+      return 0;
+
+    Score += 1;
+    if (Text[Pos] == Filter[I])
+      Score += 1;
+    if (Pos == 0 || !isAlphanumeric(Text[Pos - 1]) ||
+        (isUppercase(Text[Pos]) && isLowercase(Text[Pos - 1])))
+      Score += 3;
+    if (LastMatch != StringRef::npos && LastMatch + 1 == Pos)
+      Score += 2;
+    LastMatch = Pos++;
+  }
+
+  if (Text.size() >= Filter.size() &&
+      Text.substr(0, Filter.size()).equals_lower(Filter)) {
+    Score += 2 * Filter.size();
+    if (Text.size() == Filter.size())
+      Score += 4;
+  }
+  return Score;
+}
+
+namespace {
+  struct RankFilteredResults {
+    const std::vector<std::string> &TypedTexts;
+
+    explicit RankFilteredResults(const std::vector<std::string> &TypedTexts)
+      : TypedTexts(TypedTexts) { }
+
+    bool operator()(const FilteredCompletionResult &X,
+                    const FilteredCompletionResult &Y) const {
+      if (X.Score != Y.Score)
+        return X.Score > Y.Score;
+      if (X.Priority != Y.Priority)
+        return X.Priority < Y.Priority;
+
+      StringRef XText = TypedTexts[X.Index];
+      StringRef YText = TypedTexts[Y.Index];
+      if (int Result = XText.compare_lower(YText))
+        return Result < 0;
+      if (int Result = XText.compare(YText))
+        return Result < 0;
+      return X.Index < Y.Index;
+    }
+  };
+}
+
+extern "C" {
+unsigned clang_codeCompleteFilterResults(CXCodeCompleteResults *ResultsIn,
+                                         const char *Filter) {
+  AllocatedCXCodeCompleteResults *Results
+    = static_cast<AllocatedCXCodeCompleteResults*>(ResultsIn);
+  if (!Results)
+    return 0;
+
+  if (Results->TypedTexts.size() != Results->NumResults) {
+    Results->TypedTexts.clear();
+    Results->TypedTexts.reserve(Results->NumResults);
+    for (unsigned I = 0, N = Results->NumResults; I != N; ++I) {
+      SmallString<256> Buffer;
+      Results->TypedTexts.push_back(GetTypedName(
+          (CodeCompletionString *)Results->Results[I].CompletionString,
+          Buffer));
+    }
+  }
+
+  StringRef NewFilter = Filter ? Filter : "";
+  std::vector<FilteredCompletionResult> Matches;
+  auto AddIfMatches = [&](unsigned Index) {
+    if (unsigned Score = scoreFuzzyMatch(Results->TypedTexts[Index],
+                                         NewFilter)) {
+      CodeCompletionString *String
+        = (CodeCompletionString *)Results->Results[Index].CompletionString;
+      FilteredCompletionResult Match = { Index, Score, String->getPriority() };
+      Matches.push_back(Match);
+    }
+  };
+
+  // Anything that matches the extended filter also matched the previous one,
+  // so only those results need to be looked at again.
+  if (Results->IsFiltered && NewFilter.startswith(Results->Filter)) {
+    for (const FilteredCompletionResult &Previous : Results->FilteredResults)
+      AddIfMatches(Previous.Index);
+  } else {
+    for (unsigned I = 0, N = Results->NumResults; I != N; ++I)
+      AddIfMatches(I);
+  }
+
+  Results->IsFiltered = true;
+  Results->Filter = NewFilter;
+  Results->FilteredResults.swap(Matches);
+  Results->NumRanked = 0;
+  return Results->FilteredResults.size();
+}
+
+unsigned
+clang_codeCompleteGetFilteredResult(CXCodeCompleteResults *ResultsIn,
+                                    unsigned Rank) {
+  AllocatedCXCodeCompleteResults *Results
+    = static_cast<AllocatedCXCodeCompleteResults*>(ResultsIn);
+  if (!Results)
+    return 0;
+  std::vector<FilteredCompletionResult> &Filtered = Results->FilteredResults;
+  if (Rank >= Filtered.size())
+    return Results->NumResults;
+
+  // Only rank as many results as have been asked for, growing geometrically
+  // so that paging through the results stays linear.
+  if (Rank >= Results->NumRanked) {
+    unsigned NumToRank = std::max(Rank + 1, 2 * Results->NumRanked);
+    NumToRank = std::min(std::max(NumToRank, 64U), unsigned(Filtered.size()));
+    std::partial_sort(Filtered.begin() + Results->NumRanked,
+                      Filtered.begin() + NumToRank, Filtered.end(),
+                      RankFilteredResults(Results->TypedTexts));
+    Results->NumRanked = NumToRank;
+  }
+  return Filtered[Rank].Index;
+}
+}
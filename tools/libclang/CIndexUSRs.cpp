@@ -15,10 +15,12 @@
 #include "CXCursor.h"
 #include "CXString.h"
 #include "CXTranslationUnit.h"
+#include "CXUSRTable.h"
 #include "clang/Index/USRGeneration.h"
 #include "clang/Lex/PreprocessingRecord.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MutexGuard.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
@@ -36,6 +38,47 @@ bool cxcursor::getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf) {
   return generateUSRForDecl(D, Buf);
 }
 
+//===----------------------------------------------------------------------===//
+// USR interning.
+//===----------------------------------------------------------------------===//
+
+cxindex::InternedUSR cxindex::USRTable::intern(StringRef USR) {
+  assert(!USR.empty() && "Interning an empty USR");
+  llvm::MutexGuard Lock(Mux);
+  auto &Entry = IDs.GetOrCreateValue(USR, 0);
+  if (!Entry.getValue()) {
+    USRs.push_back(Entry.getKeyData());
+    Entry.setValue(USRs.size());
+  }
+  return InternedUSR(Entry.getValue(), Entry.getKeyData());
+}
+
+const char *cxindex::USRTable::lookup(unsigned ID) const {
+  llvm::MutexGuard Lock(Mux);
+  if (ID == 0 || ID > USRs.size())
+    return nullptr;
+  return USRs[ID - 1];
+}
+
+unsigned cxindex::USRTable::size() const {
+  llvm::MutexGuard Lock(Mux);
+  return USRs.size();
+}
+
+cxindex::InternedUSR cxindex::DeclUSRCache::getUSR(const Decl *D) {
+  llvm::DenseMap<const Decl *, InternedUSR>::iterator
+    Known = Cache.find(D);
+  if (Known != Cache.end())
+    return Known->second;
+
+  InternedUSR Result;
+  SmallString<512> Buf;
+  if (!generateUSRForDecl(D, Buf) && !Buf.empty())
+    Result = Table.intern(Buf.str());
+  Cache[D] = Result;
+  return Result;
+}
+
 extern "C" {
 
 CXString clang_getCursorUSR(CXCursor C) {
@@ -50,20 +93,16 @@ CXString clang_getCursorUSR(CXCursor C) {
     if (!TU)
       return cxstring::createEmpty();
 
-    cxstring::CXStringBuf *buf = cxstring::getCXStringBuf(TU);
-    if (!buf)
-      return cxstring::createEmpty();
-
-    bool Ignore = cxcursor::getDeclCursorUSR(D, buf->Data);
-    if (Ignore) {
-      buf->dispose();
-      return cxstring::createEmpty();
+    // USRs are memoized per declaration, but the interned strings go away
+    // when the translation unit is reparsed, so the caller gets a copy.
+    if (!TU->DeclUSRs) {
+      TU->USRs = new cxindex::USRTable();
+      TU->DeclUSRs = new cxindex::DeclUSRCache(*TU->USRs);
     }
-
-    // Return the C-string, but don't make a copy since it is already in
-    // the string buffer.
-    buf->Data.push_back('\0');
-    return createCXString(buf);
+    cxindex::InternedUSR USR = TU->DeclUSRs->getUSR(D);
+    if (!USR.Str)
+      return cxstring::createEmpty();
+    return cxstring::createDup(USR.Str);
   }
 
   if (K == CXCursor_MacroDefinition) {
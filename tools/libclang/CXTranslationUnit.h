@@ -24,6 +24,10 @@ namespace clang {
 namespace index {
 class CommentToXMLConverter;
 } // namespace index
+namespace cxindex {
+class DeclUSRCache;
+class USRTable;
+} // namespace cxindex
 } // namespace clang
 
 struct CXTranslationUnitImpl {
@@ -33,6 +37,8 @@ struct CXTranslationUnitImpl {
   void *Diagnostics;
   void *OverridenCursorsPool;
   clang::index::CommentToXMLConverter *CommentToXML;
+  clang::cxindex::USRTable *USRs;
+  clang::cxindex::DeclUSRCache *DeclUSRs;
 };
 
 namespace clang {
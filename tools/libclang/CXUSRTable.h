@@ -0,0 +1,88 @@
+//===- CXUSRTable.h - Interned USRs of declarations -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines USRTable, which interns USR strings, and DeclUSRCache,
+// which memoizes the USRs of the declarations of a translation unit.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_CXUSRTABLE_H
+#define LLVM_CLANG_CXUSRTABLE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Mutex.h"
+#include <vector>
+
+namespace clang {
+  class Decl;
+
+namespace cxindex {
+
+/// \brief An interned USR: a stable, null-terminated string and its ID.
+///
+/// IDs start at 1; the null USR, with ID 0, stands for a declaration that has
+/// no USR.
+struct InternedUSR {
+  unsigned ID;
+  const char *Str;
+
+  InternedUSR() : ID(0), Str(nullptr) { }
+  InternedUSR(unsigned ID, const char *Str) : ID(ID), Str(Str) { }
+};
+
+/// \brief Interns USR strings, giving each distinct USR an ID and storage
+/// that stay valid for the lifetime of the table.
+///
+/// The table is safe to use from multiple threads.
+class USRTable {
+  llvm::StringMap<unsigned, llvm::BumpPtrAllocator> IDs;
+  std::vector<const char *> USRs;
+  mutable llvm::sys::Mutex Mux;
+
+  USRTable(const USRTable &) LLVM_DELETED_FUNCTION;
+  void operator=(const USRTable &) LLVM_DELETED_FUNCTION;
+
+public:
+  USRTable() : Mux(/*recursive=*/false) { }
+
+  /// \brief Intern \p USR, which must not be empty.
+  InternedUSR intern(StringRef USR);
+
+  /// \returns the USR with the given ID, or null if there is none.
+  const char *lookup(unsigned ID) const;
+
+  /// \returns the number of distinct USRs in the table.
+  unsigned size() const;
+};
+
+/// \brief Memoizes the USRs of the declarations of one translation unit,
+/// interning them in a USRTable.
+///
+/// Must be cleared when the declarations it refers to go away, e.g., when the
+/// translation unit is reparsed.
+class DeclUSRCache {
+  USRTable &Table;
+  llvm::DenseMap<const Decl *, InternedUSR> Cache;
+
+public:
+  explicit DeclUSRCache(USRTable &Table) : Table(Table) { }
+
+  /// \returns the interned USR of \p D, or the null USR if \p D should be
+  /// ignored.
+  InternedUSR getUSR(const Decl *D);
+
+  void clear() { Cache.clear(); }
+};
+
+}} // end namespace clang::cxindex
+
+#endif
@@ -17,20 +17,24 @@
 #include "CXTranslationUnit.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/DeclVisitor.h"
+#include "clang/Basic/WorkerThreads.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Lexer.h"
 #include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/PPConditionalDirectiveRecord.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/SemaConsumer.h"
+#include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include <atomic>
 #include <cstdio>
 
 using namespace clang;
@@ -160,9 +164,19 @@ public:
     Set = ParsedRegions;
   }
 
-  void update(ArrayRef<PPRegion> Regions) {
+  /// \brief Records that the calling translation unit parses the bodies in
+  /// \p Region. Returns false if another translation unit already does.
+  bool claim(const PPRegion &Region) {
     llvm::MutexGuard MG(Mux);
-    ParsedRegions.insert(Regions.begin(), Regions.end());
+    return ParsedRegions.insert(Region).second;
+  }
+
+  /// \brief Gives up the claims of a translation unit that did not finish
+  /// parsing, so that later translation units parse those bodies.
+  void release(const PPRegionSetTy &Regions) {
+    llvm::MutexGuard MG(Mux);
+    for (const PPRegion &Region : Regions)
+      ParsedRegions.erase(Region);
   }
 };
 
@@ -171,19 +185,33 @@ class TUSkipBodyControl {
   PPConditionalDirectiveRecord &PPRec;
   Preprocessor &PP;
 
+  /// \brief Regions whose bodies are parsed by other translation units.
   PPRegionSetTy ParsedRegions;
-  SmallVector<PPRegion, 32> NewParsedRegions;
+  /// \brief Regions whose bodies are parsed by this translation unit.
+  PPRegionSetTy ClaimedRegions;
   PPRegion LastRegion;
   bool LastIsParsed;
+  bool Finished;
 
 public:
   TUSkipBodyControl(SessionSkipBodyData &sessionData,
                     PPConditionalDirectiveRecord &ppRec,
                     Preprocessor &pp)
-    : SessionData(sessionData), PPRec(ppRec), PP(pp) {
+    : SessionData(sessionData), PPRec(ppRec), PP(pp), Finished(false) {
     SessionData.copyTo(ParsedRegions);
   }
 
+  /// \brief Releases the claimed regions if the translation unit failed or
+  /// crashed before reaching its end.
+  ~TUSkipBodyControl() {
+    if (!Finished)
+      SessionData.release(ClaimedRegions);
+  }
+
+  /// \brief Called once the whole translation unit was parsed; its claims
+  /// are kept for the rest of the session.
+  void finished() { Finished = true; }
+
   bool isParsed(SourceLocation Loc, FileID FID, const FileEntry *FE) {
     PPRegion region = getRegion(Loc, FID, FE);
     if (region.isInvalid())
@@ -194,16 +222,22 @@ public:
       return LastIsParsed;
 
     LastRegion = region;
-    LastIsParsed = ParsedRegions.count(region);
-    if (!LastIsParsed)
-      NewParsedRegions.push_back(region);
+    if (ParsedRegions.count(region)) {
+      LastIsParsed = true;
+    } else if (ClaimedRegions.count(region)) {
+      LastIsParsed = false;
+    } else if (SessionData.claim(region)) {
+      // Claim the region as soon as its first body is parsed, so that
+      // translation units indexed concurrently skip it.
+      ClaimedRegions.insert(region);
+      LastIsParsed = false;
+    } else {
+      ParsedRegions.insert(region);
+      LastIsParsed = true;
+    }
     return LastIsParsed;
   }
 
-  void finished() {
-    SessionData.update(NewParsedRegions);
-  }
-
 private:
   PPRegion getRegion(SourceLocation Loc, FileID FID, const FileEntry *FE) {
     SourceLocation RegionLoc = PPRec.findConditionalDirectiveRegionLoc(Loc);
@@ -303,10 +337,14 @@ public:
 class IndexingConsumer : public ASTConsumer {
   IndexingContext &IndexCtx;
   TUSkipBodyControl *SKCtrl;
+  unsigned FocusStartLine;
+  unsigned FocusEndLine;
 
 public:
-  IndexingConsumer(IndexingContext &indexCtx, TUSkipBodyControl *skCtrl)
-    : IndexCtx(indexCtx), SKCtrl(skCtrl) { }
+  IndexingConsumer(IndexingContext &indexCtx, TUSkipBodyControl *skCtrl,
+                   unsigned focusStartLine, unsigned focusEndLine)
+    : IndexCtx(indexCtx), SKCtrl(skCtrl), FocusStartLine(focusStartLine),
+      FocusEndLine(focusEndLine) { }
 
   // ASTConsumer Implementation
 
@@ -316,7 +354,10 @@ public:
   }
 
   void HandleTranslationUnit(ASTContext &Ctx) override {
-    if (SKCtrl)
+    // A translation unit that was aborted or hit a fatal error may not have
+    // parsed all the bodies it claimed.
+    if (SKCtrl && !IndexCtx.shouldAbort() &&
+        !Ctx.getDiagnostics().hasFatalErrorOccurred())
       SKCtrl->finished();
   }
 
@@ -353,7 +394,7 @@ public:
   }
 
   bool shouldSkipFunctionBody(Decl *D) override {
-    if (!SKCtrl) {
+    if (!SKCtrl && FocusStartLine == 0) {
       // Always skip bodies.
       return true;
     }
@@ -368,8 +409,12 @@ public:
     FileID FID;
     unsigned Offset;
     std::tie(FID, Offset) = SM.getDecomposedLoc(Loc);
-    // Don't skip bodies from main files; this may be revisited.
+    // Only skip bodies from main files that are outside the focus range.
     if (SM.getMainFileID() == FID)
+      return FocusStartLine != 0 && !isInFocusRange(D);
+    // With only a focus range, header bodies are parsed; otherwise they are
+    // skipped once parsed by another translation unit of the session.
+    if (!SKCtrl)
       return false;
     const FileEntry *FE = SM.getFileEntryForID(FID);
     if (!FE)
@@ -377,6 +422,55 @@ public:
 
     return SKCtrl->isParsed(Loc, FID, FE);
   }
+
+private:
+  /// \brief Whether the function \p D, whose body is about to be parsed,
+  /// overlaps the focus range.
+  bool isInFocusRange(Decl *D) {
+    const SourceManager &SM = IndexCtx.getASTContext().getSourceManager();
+    if (SM.getExpansionLineNumber(D->getLocStart()) > FocusEndLine)
+      return false;
+    SourceLocation EndLoc = SM.getExpansionLoc(D->getLocEnd());
+    if (SM.getExpansionLineNumber(EndLoc) >= FocusStartLine)
+      return true;
+
+    // The body has not been parsed yet; raw-lex up to its closing brace to
+    // find out where it ends.
+    FileID FID;
+    unsigned Offset;
+    std::tie(FID, Offset) = SM.getDecomposedLoc(EndLoc);
+    bool Invalid = false;
+    StringRef Buf = SM.getBufferData(FID, &Invalid);
+    if (Invalid)
+      return true;
+
+    Lexer RawLex(SM.getLocForStartOfFile(FID),
+                 IndexCtx.getASTContext().getLangOpts(), Buf.begin(),
+                 Buf.begin() + Offset, Buf.end());
+    unsigned Depth = 0;
+    bool SeenBrace = false;
+    Token Tok;
+    while (!RawLex.LexFromRawLexer(Tok)) {
+      if (Tok.is(tok::l_brace)) {
+        ++Depth;
+        SeenBrace = true;
+      } else if (Tok.is(tok::r_brace) && Depth && --Depth == 0) {
+        // A braced member initializer is followed by ',' or by the body.
+        Token Next;
+        if (!RawLex.LexFromRawLexer(Next) &&
+            (Next.is(tok::comma) || Next.is(tok::l_brace))) {
+          if (Next.is(tok::l_brace))
+            ++Depth;
+          continue;
+        }
+        break;
+      }
+    }
+    if (!SeenBrace)
+      return true;
+    return SM.getLineNumber(FID, SM.getFileOffset(Tok.getLocation())) >=
+           FocusStartLine;
+  }
 };
 
 //===----------------------------------------------------------------------===//
@@ -404,15 +498,20 @@ class IndexingFrontendAction : public ASTFrontendAction {
 
   SessionSkipBodyData *SKData;
   std::unique_ptr<TUSkipBodyControl> SKCtrl;
+  unsigned FocusStartLine;
+  unsigned FocusEndLine;
 
 public:
   IndexingFrontendAction(CXClientData clientData,
                          IndexerCallbacks &indexCallbacks,
                          unsigned indexOptions,
                          CXTranslationUnit cxTU,
-                         SessionSkipBodyData *skData)
-    : IndexCtx(clientData, indexCallbacks, indexOptions, cxTU),
-      CXTU(cxTU), SKData(skData) { }
+                         USRTable &USRs,
+                         SessionSkipBodyData *skData,
+                         unsigned focusStartLine, unsigned focusEndLine)
+    : IndexCtx(clientData, indexCallbacks, indexOptions, cxTU, USRs),
+      CXTU(cxTU), SKData(skData), FocusStartLine(focusStartLine),
+      FocusEndLine(focusEndLine) { }
 
   ASTConsumer *CreateASTConsumer(CompilerInstance &CI,
                                  StringRef InFile) override {
@@ -435,7 +534,8 @@ public:
       SKCtrl.reset(new TUSkipBodyControl(*SKData, *PPRec, PP));
     }
 
-    return new IndexingConsumer(IndexCtx, SKCtrl.get());
+    return new IndexingConsumer(IndexCtx, SKCtrl.get(), FocusStartLine,
+                                FocusEndLine);
   }
 
   void EndSourceFileAction() override {
@@ -458,9 +558,16 @@ public:
 struct IndexSessionData {
   CXIndex CIdx;
   std::unique_ptr<SessionSkipBodyData> SkipBodyData;
+  /// \brief The USRs reported by the session, shared by all its translation
+  /// units.
+  USRTable USRs;
+  /// \brief Main file lines whose function bodies are parsed; 0 if unset.
+  unsigned FocusStartLine;
+  unsigned FocusEndLine;
 
   explicit IndexSessionData(CXIndex cIdx)
-    : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData) {}
+    : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData), FocusStartLine(0),
+      FocusEndLine(0) {}
 };
 
 struct IndexSourceFileInfo {
@@ -610,13 +717,18 @@ static void clang_indexSourceFile_Impl(void *UserData) {
   // revisited.
   bool SkipBodies = (index_options & CXIndexOpt_SkipParsedBodiesInSession) &&
       CInvok->getLangOpts()->CPlusPlus;
-  if (SkipBodies)
+  bool HasFocus = IdxSession->FocusStartLine != 0 &&
+      CInvok->getLangOpts()->CPlusPlus;
+  if (SkipBodies || HasFocus)
     CInvok->getFrontendOpts().SkipFunctionBodies = true;
 
   std::unique_ptr<IndexingFrontendAction> IndexAction;
   IndexAction.reset(new IndexingFrontendAction(client_data, CB,
                                                index_options, CXTU->getTU(),
-                        SkipBodies ? IdxSession->SkipBodyData.get() : nullptr));
+                                               IdxSession->USRs,
+                        SkipBodies ? IdxSession->SkipBodyData.get() : nullptr,
+                        HasFocus ? IdxSession->FocusStartLine : 0,
+                        IdxSession->FocusEndLine));
 
   // Recover resources if we crash before exiting this method.
   llvm::CrashRecoveryContextCleanupRegistrar<IndexingFrontendAction>
@@ -673,6 +785,88 @@ static void clang_indexSourceFile_Impl(void *UserData) {
   ITUI->result = CXError_Success;
 }
 
+//===----------------------------------------------------------------------===//
+// clang_indexCompilationDatabase Implementation
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// \brief A compile command to index, along with the file it compiles.
+typedef std::pair<std::string, tooling::CompileCommand> FileCompileCommand;
+
+/// \brief The state shared by the worker threads of a
+/// clang_indexCompilationDatabase call.
+struct IndexCompilationDatabaseInfo {
+  CXIndexAction idxAction;
+  CXClientData client_data;
+  IndexerCallbacks *index_callbacks;
+  unsigned index_callbacks_size;
+  unsigned index_options;
+  CXIndexProgressCallback progress;
+  std::vector<FileCompileCommand> Commands;
+
+  /// \brief The index of the next compile command to pick up.
+  std::atomic<unsigned> NextCommand;
+
+  /// \brief Guards the counters below and the progress callback.
+  llvm::sys::Mutex ProgressMux;
+  unsigned NumIndexed;
+  unsigned NumFailed;
+
+  IndexCompilationDatabaseInfo()
+    : NextCommand(0), ProgressMux(/*recursive=*/false), NumIndexed(0),
+      NumFailed(0) {}
+};
+
+} // anonymous namespace
+
+/// \brief Index compile commands until there are none left; run by every
+/// worker thread.
+static void indexCompileCommands(IndexCompilationDatabaseInfo &Info) {
+  while (true) {
+    unsigned I = Info.NextCommand++;
+    if (I >= Info.Commands.size())
+      return;
+    const std::string &Filename = Info.Commands[I].first;
+    const tooling::CompileCommand &Cmd = Info.Commands[I].second;
+
+    // Relative paths are resolved against the directory of the command rather
+    // than by changing the working directory, which is shared by all threads.
+    // The compiler executable itself is not an argument for libclang.
+    std::vector<const char *> Args;
+    Args.push_back("-working-directory");
+    Args.push_back(Cmd.Directory.c_str());
+    for (unsigned A = 1, N = Cmd.CommandLine.size(); A < N; ++A)
+      Args.push_back(Cmd.CommandLine[A].c_str());
+
+    std::vector<CXUnsavedFile> UnsavedFiles;
+    for (const auto &Source : Cmd.MappedSources) {
+      CXUnsavedFile UF = { Source.first.c_str(), Source.second.data(),
+                           Source.second.size() };
+      UnsavedFiles.push_back(UF);
+    }
+
+    int Result = clang_indexSourceFile(Info.idxAction, Info.client_data,
+                                       Info.index_callbacks,
+                                       Info.index_callbacks_size,
+                                       Info.index_options,
+                                       /*source_filename=*/nullptr,
+                                       Args.data(), Args.size(),
+                                       UnsavedFiles.data(),
+                                       UnsavedFiles.size(),
+                                       /*out_TU=*/nullptr,
+                                       CXTranslationUnit_None);
+
+    llvm::MutexGuard MG(Info.ProgressMux);
+    ++Info.NumIndexed;
+    if (Result)
+      ++Info.NumFailed;
+    if (Info.progress)
+      Info.progress(Info.client_data, Filename.c_str(), Info.NumIndexed,
+                    Info.Commands.size(), Result);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // clang_indexTranslationUnit Implementation
 //===----------------------------------------------------------------------===//
@@ -772,15 +966,24 @@ static void clang_indexTranslationUnit_Impl(void *UserData) {
                                   ? index_callbacks_size : sizeof(CB);
   memcpy(&CB, client_index_callbacks, ClientCBSize);
 
+  // Intern the USRs in the session, if there is one.
+  USRTable LocalUSRs;
+  USRTable &USRs = ITUI->idxAction
+      ? static_cast<IndexSessionData *>(ITUI->idxAction)->USRs
+      : LocalUSRs;
+
   std::unique_ptr<IndexingContext> IndexCtx;
-  IndexCtx.reset(new IndexingContext(client_data, CB, index_options, TU));
+  IndexCtx.reset(new IndexingContext(client_data, CB, index_options, TU,
+                                     USRs));
 
   // Recover resources if we crash before exiting this method.
   llvm::CrashRecoveryContextCleanupRegistrar<IndexingContext>
     IndexCtxCleanup(IndexCtx.get());
 
   std::unique_ptr<IndexingConsumer> IndexConsumer;
-  IndexConsumer.reset(new IndexingConsumer(*IndexCtx, nullptr));
+  IndexConsumer.reset(new IndexingConsumer(*IndexCtx, nullptr,
+                                           /*focusStartLine=*/0,
+                                           /*focusEndLine=*/0));
 
   // Recover resources if we crash before exiting this method.
   llvm::CrashRecoveryContextCleanupRegistrar<IndexingConsumer>
@@ -934,6 +1137,18 @@ void clang_index_setClientContainer(const CXIdxContainerInfo *info,
   Container->IndexCtx->addContainerInMap(Container->DC, client);
 }
 
+unsigned clang_index_getEntityUSRID(const CXIdxEntityInfo *info) {
+  if (!info)
+    return 0;
+  return static_cast<const EntityInfo *>(info)->USRID;
+}
+
+const char *clang_IndexAction_getUSR(CXIndexAction idxAction, unsigned usrID) {
+  if (!idxAction)
+    return nullptr;
+  return static_cast<IndexSessionData *>(idxAction)->USRs.lookup(usrID);
+}
+
 CXIdxClientEntity clang_index_getClientEntity(const CXIdxEntityInfo *info) {
   if (!info)
     return nullptr;
@@ -958,6 +1173,15 @@ void clang_IndexAction_dispose(CXIndexAction idxAction) {
     delete static_cast<IndexSessionData *>(idxAction);
 }
 
+void clang_IndexAction_setFocusRange(CXIndexAction idxAction,
+                                     unsigned start_line, unsigned end_line) {
+  if (!idxAction)
+    return;
+  IndexSessionData *IdxSession = static_cast<IndexSessionData *>(idxAction);
+  IdxSession->FocusStartLine = start_line;
+  IdxSession->FocusEndLine = start_line ? end_line : 0;
+}
+
 int clang_indexSourceFile(CXIndexAction idxAction,
                           CXClientData client_data,
                           IndexerCallbacks *index_callbacks,
@@ -1061,6 +1285,45 @@ int clang_indexTranslationUnit(CXIndexAction idxAction,
   return ITUI.result;
 }
 
+int clang_indexCompilationDatabase(CXIndexAction idxAction,
+                                   CXClientData client_data,
+                                   IndexerCallbacks *index_callbacks,
+                                   unsigned index_callbacks_size,
+                                   unsigned index_options,
+                                   CXCompilationDatabase database,
+                                   unsigned num_threads,
+                                   CXIndexProgressCallback progress) {
+  LOG_FUNC_SECTION {
+    *Log << "num_threads=" << num_threads;
+  }
+
+  tooling::CompilationDatabase *DB =
+      static_cast<tooling::CompilationDatabase *>(database);
+  if (!idxAction || !DB || !index_callbacks || index_callbacks_size == 0)
+    return CXError_InvalidArguments;
+
+  IndexCompilationDatabaseInfo Info;
+  Info.idxAction = idxAction;
+  Info.client_data = client_data;
+  Info.index_callbacks = index_callbacks;
+  Info.index_callbacks_size = index_callbacks_size;
+  Info.index_options = index_options;
+  Info.progress = progress;
+  for (const auto &File : DB->getAllFiles())
+    for (auto &Cmd : DB->getCompileCommands(File))
+      Info.Commands.push_back(FileCompileCommand(File, std::move(Cmd)));
+
+  // The index computes its resource directory lazily, without locking; do it
+  // before the workers need it.
+  IndexSessionData *IdxSession = static_cast<IndexSessionData *>(idxAction);
+  static_cast<CIndexer *>(IdxSession->CIdx)->getClangResourcesPath();
+
+  runOnWorkerThreads([&Info]() { indexCompileCommands(Info); }, num_threads,
+                     Info.Commands.size());
+
+  return Info.NumFailed ? CXError_Failure : CXError_Success;
+}
+
 void clang_indexLoc_getFileLocation(CXIdxLoc location,
                                     CXIdxClientFile *indexFile,
                                     CXFile *file,
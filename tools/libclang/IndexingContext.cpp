@@ -1107,15 +1107,10 @@ void IndexingContext::getEntityInfo(const NamedDecl *D,
     EntityInfo.name = SA.copyCStr(StrBuf.str());
   }
 
-  {
-    SmallString<512> StrBuf;
-    bool Ignore = getDeclCursorUSR(D, StrBuf);
-    if (Ignore) {
-      EntityInfo.USR = nullptr;
-    } else {
-      EntityInfo.USR = SA.copyCStr(StrBuf.str());
-    }
-  }
+  // The interned USR outlives the indexing session; no need to copy it.
+  InternedUSR USR = DeclUSRs.getUSR(D);
+  EntityInfo.USR = USR.Str;
+  EntityInfo.USRID = USR.ID;
 }
 
 void IndexingContext::getContainerInfo(const DeclContext *DC,
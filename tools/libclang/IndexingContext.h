@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "CXCursor.h"
+#include "CXUSRTable.h"
 #include "Index_Internal.h"
 #include "clang/AST/DeclGroup.h"
 #include "clang/AST/DeclObjC.h"
@@ -47,11 +48,14 @@ struct EntityInfo : public CXIdxEntityInfo {
   const NamedDecl *Dcl;
   IndexingContext *IndexCtx;
   IntrusiveRefCntPtr<AttrListInfo> AttrList;
+  /// \brief The ID of \c USR in the indexing session, or 0 if there is none.
+  unsigned USRID;
 
   EntityInfo() {
     name = USR = nullptr;
     attributes = nullptr;
     numAttributes = 0;
+    USRID = 0;
   }
 };
 
@@ -295,6 +299,10 @@ class IndexingContext {
   unsigned StrAdapterCount;
   friend class ScratchAlloc;
 
+  /// \brief The USRs of the declarations of this translation unit, interned
+  /// in the table of the indexing session.
+  DeclUSRCache DeclUSRs;
+
   struct ObjCProtocolListInfo {
     SmallVector<CXIdxObjCProtocolRefInfo, 4> ProtInfos;
     SmallVector<EntityInfo, 4> ProtEntities;
@@ -332,10 +340,11 @@ class IndexingContext {
 
 public:
   IndexingContext(CXClientData clientData, IndexerCallbacks &indexCallbacks,
-                  unsigned indexOptions, CXTranslationUnit cxTU)
+                  unsigned indexOptions, CXTranslationUnit cxTU,
+                  USRTable &USRs)
     : Ctx(nullptr), ClientData(clientData), CB(indexCallbacks),
       IndexOptions(indexOptions), CXTU(cxTU),
-      StrScratch(), StrAdapterCount(0) { }
+      StrScratch(), StrAdapterCount(0), DeclUSRs(USRs) { }
 
   ASTContext &getASTContext() const { return *Ctx; }
 
@@ -4302,6 +4302,68 @@ TEST(MatchFinder, InterceptsEndOfTranslationUnit) {
   EXPECT_TRUE(VerifyCallback.Called);
 }
 
+TEST(MatchFinder, DispatchesOnMostDerivedKind) {
+  using ast_type_traits::ASTNodeKind;
+  EXPECT_TRUE(internal::DynTypedMatcher(recordDecl())
+                  .getRestrictKind()
+                  .isSame(ASTNodeKind::getFromNodeKind<CXXRecordDecl>()));
+  EXPECT_TRUE(internal::DynTypedMatcher(
+                  DeclarationMatcher(recordDecl(hasName("X")).bind("x")))
+                  .getRestrictKind()
+                  .isSame(ASTNodeKind::getFromNodeKind<CXXRecordDecl>()));
+  EXPECT_TRUE(internal::DynTypedMatcher(
+                  StatementMatcher(callExpr(callee(functionDecl()))))
+                  .getRestrictKind()
+                  .isSame(ASTNodeKind::getFromNodeKind<CallExpr>()));
+  EXPECT_TRUE(internal::DynTypedMatcher(
+                  DeclarationMatcher(anyOf(recordDecl(), functionDecl())))
+                  .getRestrictKind()
+                  .isSame(ASTNodeKind::getFromNodeKind<Decl>()));
+
+  // Matchers that are skipped for a node kind still run for other kinds.
+  EXPECT_TRUE(matches("class X {}; void f() { f(); }",
+                      recordDecl(hasName("X"))));
+  EXPECT_TRUE(matches("class X {}; void f() { f(); }",
+                      callExpr(callee(functionDecl(hasName("f"))))));
+  EXPECT_TRUE(matches("class X {}; void f() { f(); }",
+                      decl(anyOf(recordDecl(hasName("Y")),
+                                 functionDecl(hasName("f"))))));
+}
+
+class ProfiledCallback : public MatchFinder::MatchCallback {
+public:
+  void run(const MatchFinder::MatchResult &Result) override {}
+  StringRef getID() const override { return "profiled"; }
+};
+
+TEST(MatchFinder, ProfilesMatchers) {
+  llvm::StringMap<MatcherProfile> Records;
+  MatchFinder::MatchFinderOptions Options;
+  Options.ProfileRecords = &Records;
+  MatchFinder Finder(Options);
+  ProfiledCallback Callback;
+  internal::CollectMatchesCallback NoIDCallback;
+  Finder.addMatcher(functionDecl(hasDescendant(callExpr())), &Callback);
+  Finder.addMatcher(varDecl(), &NoIDCallback);
+  std::unique_ptr<ASTUnit> AST(
+      tooling::buildASTFromCode("void f(); void g() { f(); } int x;"));
+  ASSERT_TRUE(AST.get());
+  Finder.matchAST(AST->getASTContext());
+
+  ASSERT_EQ(2u, Records.size());
+  const MatcherProfile &Profile = Records["profiled"];
+  EXPECT_EQ(2u, Profile.Invocations);
+  EXPECT_EQ(1u, Profile.Matches);
+  EXPECT_EQ(2u, Profile.CacheMisses);
+  EXPECT_EQ(1u, Records["matcher #1"].Invocations);
+  EXPECT_EQ(1u, Records["matcher #1"].Matches);
+
+  std::string Report;
+  llvm::raw_string_ostream OS(Report);
+  printMatcherProfiles(Records, OS);
+  EXPECT_NE(std::string::npos, OS.str().find("profiled"));
+}
+
 TEST(EqualsBoundNodeMatcher, QualType) {
   EXPECT_TRUE(matches(
       "int i = 1;", varDecl(hasType(qualType().bind("type")),
@@ -0,0 +1,106 @@
+//===- unittests/Analysis/AnalysisDeclContextTest.cpp ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Unit tests for the contexts kept by AnalysisDeclContextManager.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Analysis/AnalysisContext.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+
+namespace clang {
+namespace {
+
+const FunctionDecl *findFunction(ASTUnit &AST, StringRef Name) {
+  TranslationUnitDecl *TU = AST.getASTContext().getTranslationUnitDecl();
+  for (const Decl *D : TU->decls())
+    if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D))
+      if (FD->getName() == Name)
+        return FD;
+  return nullptr;
+}
+
+class AnalysisDeclContextManagerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    AST = tooling::buildASTFromCode("void a() {}\n"
+                                    "void b() {}\n"
+                                    "void c() {}\n"
+                                    "void d() {}\n");
+    ASSERT_TRUE(AST.get() != nullptr);
+    A = findFunction(*AST, "a");
+    B = findFunction(*AST, "b");
+    C = findFunction(*AST, "c");
+    D = findFunction(*AST, "d");
+    ASSERT_TRUE(A && B && C && D);
+  }
+
+  std::unique_ptr<ASTUnit> AST;
+  const FunctionDecl *A, *B, *C, *D;
+};
+
+TEST_F(AnalysisDeclContextManagerTest, ClearKeepsMostRecentlyUsed) {
+  AnalysisDeclContextManager Mgr;
+  Mgr.getContext(A);
+  Mgr.getContext(B);
+  Mgr.getContext(C);
+  Mgr.getContext(D);
+  // Using A again makes it the most recently used context.
+  Mgr.getContext(A);
+
+  Mgr.clear(2);
+  EXPECT_TRUE(Mgr.hasContext(A));
+  EXPECT_FALSE(Mgr.hasContext(B));
+  EXPECT_FALSE(Mgr.hasContext(C));
+  EXPECT_TRUE(Mgr.hasContext(D));
+
+  // A kept context is returned as is; an evicted one is created again.
+  AnalysisDeclContext *KeptA = Mgr.getContext(A);
+  Mgr.clear(2);
+  EXPECT_EQ(KeptA, Mgr.getContext(A));
+  Mgr.getContext(B);
+  EXPECT_TRUE(Mgr.hasContext(B));
+
+  // A, D and B are kept; D is the least recently used.
+  Mgr.clear(2);
+  EXPECT_TRUE(Mgr.hasContext(A));
+  EXPECT_TRUE(Mgr.hasContext(B));
+  EXPECT_FALSE(Mgr.hasContext(D));
+}
+
+TEST_F(AnalysisDeclContextManagerTest, ClearKeepsAllIfFewerThanRequested) {
+  AnalysisDeclContextManager Mgr;
+  Mgr.getContext(A);
+  Mgr.getContext(B);
+
+  Mgr.clear(2);
+  EXPECT_TRUE(Mgr.hasContext(A));
+  EXPECT_TRUE(Mgr.hasContext(B));
+
+  Mgr.clear(16);
+  EXPECT_TRUE(Mgr.hasContext(A));
+  EXPECT_TRUE(Mgr.hasContext(B));
+}
+
+TEST_F(AnalysisDeclContextManagerTest, ClearWithoutKeepingDiscardsAll) {
+  AnalysisDeclContextManager Mgr;
+  Mgr.getContext(A);
+  Mgr.getContext(B);
+
+  Mgr.clear();
+  EXPECT_FALSE(Mgr.hasContext(A));
+  EXPECT_FALSE(Mgr.hasContext(B));
+}
+
+} // end anonymous namespace
+} // end namespace clang
@@ -9097,5 +9097,34 @@ TEST_F(FormatTest, HandleConflictMarkers) {
                    "int i;\n"));
 }
 
+TEST_F(FormatTest, FormatsIdenticallyWithCache) {
+  std::string Code = "int f() {\n"
+                     "  return aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa(bbbbbbbbbbbbbbbbbbb, "
+                     "cccccccccccccccccc, ddddddddddddddd);\n"
+                     "}\n"
+                     "void g() { aaaaaaaaaaaaaaaaaaaa = bbbbbbbbbbbbbbbbbbbbbbbbbbb + "
+                     "ccccccccccccccccccccccc + dddddddddddddddd; }\n";
+  FormatStyle Style = getLLVMStyle();
+  std::vector<tooling::Range> Ranges(1, tooling::Range(0, Code.size()));
+  std::string Expected =
+      applyAllReplacements(Code, reformat(Style, Code, Ranges));
+
+  FormattingCache Cache;
+  EXPECT_EQ(Expected, applyAllReplacements(
+                          Code, reformat(Style, Code, Ranges, "a.cc", &Cache)));
+  unsigned Size = Cache.size();
+  EXPECT_NE(0u, Size);
+  EXPECT_EQ(Expected, applyAllReplacements(
+                          Code, reformat(Style, Code, Ranges, "a.cc", &Cache)));
+  EXPECT_EQ(Size, Cache.size());
+
+  // A different style must not reuse the cached formatting.
+  Style.ColumnLimit = 40;
+  EXPECT_EQ(applyAllReplacements(Code, reformat(Style, Code, Ranges)),
+            applyAllReplacements(
+                Code, reformat(Style, Code, Ranges, "a.cc", &Cache)));
+  EXPECT_LT(Size, Cache.size());
+}
+
 } // end namespace tooling
 } // end namespace clang
@@ -149,6 +149,40 @@ TEST_F(ReplacementTest, SkipsDuplicateReplacements) {
   EXPECT_EQ("line1\nreplaced\nline3\nline4", Context.getRewrittenText(ID));
 }
 
+TEST(ReplacementsTest, SortsAndDeduplicatesInsertions) {
+  std::vector<Replacement> Input;
+  Input.push_back(Replacement("a.cc", 8, 1, "x"));
+  Input.push_back(Replacement("a.cc", 0, 1, "y"));
+  Input.push_back(Replacement("a.cc", 8, 1, "x"));
+  Input.push_back(Replacement("b.cc", 4, 0, "z"));
+  Replacements Replaces;
+  Replaces.insert(Input.begin(), Input.end());
+  ASSERT_EQ(3u, Replaces.size());
+
+  Replaces.insert(Replacement("a.cc", 2, 1, "w"));
+  Replaces.insert(Replacement("a.cc", 0, 1, "y"));
+  ASSERT_EQ(4u, Replaces.size());
+  Replacements::const_iterator I = Replaces.begin();
+  EXPECT_EQ(Replacement("a.cc", 0, 1, "y"), *I++);
+  EXPECT_EQ(Replacement("a.cc", 2, 1, "w"), *I++);
+  EXPECT_EQ(Replacement("b.cc", 4, 0, "z"), *I++);
+  EXPECT_EQ(Replacement("a.cc", 8, 1, "x"), *I++);
+  EXPECT_TRUE(I == Replaces.end());
+}
+
+TEST(ReplacementsTest, FindsConflictsWithinEachFile) {
+  Replacements Replaces;
+  Replaces.insert(Replacement("a.cc", 0, 10, "x"));
+  Replaces.insert(Replacement("b.cc", 2, 2, "y"));
+  Replaces.insert(Replacement("a.cc", 5, 2, "z"));
+  Replaces.insert(Replacement("a.cc", 10, 2, "w"));
+  Replaces.insert(Replacement("b.cc", 3, 0, "v"));
+  std::vector<Replacement> Conflicts = Replaces.getConflicts();
+  ASSERT_EQ(2u, Conflicts.size());
+  EXPECT_EQ(Replacement("b.cc", 3, 0, "v"), Conflicts[0]);
+  EXPECT_EQ(Replacement("a.cc", 5, 2, "z"), Conflicts[1]);
+}
+
 TEST_F(ReplacementTest, ApplyAllFailsIfOneApplyFails) {
   // This test depends on the value of the file name of an invalid source
   // location being in the range ]a, z[.
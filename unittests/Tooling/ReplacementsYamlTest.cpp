@@ -12,6 +12,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/ReplacementsYaml.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/ReplacementsExport.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -104,3 +110,136 @@ TEST(ReplacementsYamlTest, deserializesWithoutContext) {
   ASSERT_EQ(10u, DocActual.Replacements[0].getLength());
   ASSERT_EQ("replacement", DocActual.Replacements[0].getReplacementText());
 }
+
+TEST(ReplacementsYamlTest, mergesExportedReplacements) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("replacements-export", Dir));
+
+  // Both translation units share a header replacement.
+  TranslationUnitReplacements Doc1;
+  Doc1.MainSourceFile = "/path/to/a/source.cpp";
+  Doc1.Replacements.push_back(Replacement("/path/to/header.h", 10, 1, "x"));
+  Doc1.Replacements.push_back(Replacement("/path/to/a/source.cpp", 5, 0, "y"));
+  TranslationUnitReplacements Doc2;
+  Doc2.MainSourceFile = "/path/to/b/source.cpp";
+  Doc2.Replacements.push_back(Replacement("/path/to/header.h", 10, 1, "x"));
+
+  std::string ErrorMessage;
+  ASSERT_TRUE(exportReplacements(Doc1, Dir, ErrorMessage)) << ErrorMessage;
+  ASSERT_TRUE(exportReplacements(Doc2, Dir, ErrorMessage)) << ErrorMessage;
+  // Exporting a translation unit again replaces its earlier document.
+  ASSERT_TRUE(exportReplacements(Doc2, Dir, ErrorMessage)) << ErrorMessage;
+
+  Replacements Merged;
+  ASSERT_TRUE(mergeExportedReplacements(Dir, Merged, ErrorMessage))
+      << ErrorMessage;
+  ASSERT_EQ(2u, Merged.size());
+  EXPECT_EQ(Replacement("/path/to/a/source.cpp", 5, 0, "y"), *Merged.begin());
+  EXPECT_EQ(Replacement("/path/to/header.h", 10, 1, "x"),
+            *(Merged.begin() + 1));
+
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(Dir.str(), EC), E; I != E && !EC;
+       I.increment(EC))
+    llvm::sys::fs::remove(I->path());
+  llvm::sys::fs::remove(Dir.str());
+}
+
+#ifndef LLVM_ON_WIN32
+namespace {
+/// \brief Replaces the start of the main file with the definition of
+/// \c VARIANT, and the start of a header shared by all translation units.
+class VariantAction : public clang::SyntaxOnlyAction {
+public:
+  VariantAction(Replacements &Replaces) : Replaces(Replaces) {}
+
+  void EndSourceFileAction() override {
+    for (const auto &Macro :
+         getCompilerInstance().getPreprocessorOpts().Macros)
+      if (StringRef(Macro.first).startswith("VARIANT="))
+        Replaces.insert(Replacement(getCurrentFile(), 0, 0, Macro.first));
+    Replaces.insert(Replacement("/shared.h", 0, 0, "shared"));
+  }
+
+private:
+  Replacements &Replaces;
+};
+
+class VariantActionFactory : public RefactoringActionFactory {
+public:
+  clang::FrontendAction *create(Replacements &Replaces) override {
+    return new VariantAction(Replaces);
+  }
+};
+
+/// \brief Builds every file twice, with VARIANT defined to 1 and to 2.
+class TwoVariantsCompilationDatabase : public CompilationDatabase {
+public:
+  std::vector<CompileCommand>
+  getCompileCommands(StringRef FilePath) const override {
+    std::vector<CompileCommand> Commands;
+    for (const char *Variant : { "-DVARIANT=1", "-DVARIANT=2" }) {
+      std::vector<std::string> CommandLine;
+      CommandLine.push_back("clang-tool");
+      CommandLine.push_back(Variant);
+      CommandLine.push_back(FilePath);
+      Commands.push_back(CompileCommand("/", std::move(CommandLine)));
+    }
+    return Commands;
+  }
+
+  std::vector<std::string> getAllFiles() const override {
+    return std::vector<std::string>();
+  }
+
+  std::vector<CompileCommand> getAllCompileCommands() const override {
+    return std::vector<CompileCommand>();
+  }
+};
+} // end anonymous namespace
+
+TEST(ReplacementsYamlTest, exportsReplacementsOfParallelRuns) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("replacements-export", Dir));
+
+  TwoVariantsCompilationDatabase Compilations;
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  ClangTool Tool(Compilations, Sources);
+  Tool.mapVirtualFile("/a.cc", "int a = VARIANT;");
+  Tool.mapVirtualFile("/b.cc", "int b = VARIANT;");
+
+  VariantActionFactory Factory;
+  ExportReplacementsAction Action(&Factory, Dir);
+  EXPECT_EQ(0, Tool.runInParallel(&Action, 2));
+
+  // Each of the four translation units has its own document, so the
+  // replacements of both builds of a file survive.
+  unsigned NumDocuments = 0;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(Dir.str(), EC), E; I != E && !EC;
+       I.increment(EC))
+    ++NumDocuments;
+  EXPECT_EQ(4u, NumDocuments);
+
+  Replacements Merged;
+  std::string ErrorMessage;
+  ASSERT_TRUE(mergeExportedReplacements(Dir, Merged, ErrorMessage))
+      << ErrorMessage;
+  ASSERT_EQ(5u, Merged.size());
+  Replacements::const_iterator Merge = Merged.begin();
+  EXPECT_EQ(Replacement("/a.cc", 0, 0, "VARIANT=1"), *Merge++);
+  EXPECT_EQ(Replacement("/a.cc", 0, 0, "VARIANT=2"), *Merge++);
+  EXPECT_EQ(Replacement("/b.cc", 0, 0, "VARIANT=1"), *Merge++);
+  EXPECT_EQ(Replacement("/b.cc", 0, 0, "VARIANT=2"), *Merge++);
+  EXPECT_EQ(Replacement("/shared.h", 0, 0, "shared"), *Merge++);
+
+  for (llvm::sys::fs::directory_iterator I(Dir.str(), EC), E; I != E && !EC;
+       I.increment(EC))
+    llvm::sys::fs::remove(I->path());
+  llvm::sys::fs::remove(Dir.str());
+}
+#endif
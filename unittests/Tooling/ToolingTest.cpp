@@ -18,7 +18,10 @@
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/MutexGuard.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <string>
 
 namespace clang {
@@ -347,6 +350,105 @@ TEST(ClangToolTest, InjectDiagnosticConsumerInBuildASTs) {
   EXPECT_EQ(1u, ASTs.size());
   EXPECT_EQ(1u, Consumer.NumDiagnosticsSeen);
 }
+
+namespace {
+/// Records the files it is run on, and the errors reported on them.
+struct RecordingActionFactory : public FrontendActionFactory {
+  class RecordingAction : public SyntaxOnlyAction {
+    RecordingActionFactory &Factory;
+
+  public:
+    RecordingAction(RecordingActionFactory &Factory) : Factory(Factory) {}
+
+    bool BeginSourceFileAction(CompilerInstance &CI,
+                               StringRef Filename) override {
+      llvm::MutexGuard Guard(Factory.Mux);
+      Factory.Files.push_back(Filename);
+      return true;
+    }
+  };
+
+  FrontendAction *create() override { return new RecordingAction(*this); }
+
+  llvm::sys::Mutex Mux;
+  std::vector<std::string> Files;
+};
+
+/// Records the errors it is given, with the file they are in.
+struct RecordingDiagnosticConsumer : public DiagnosticConsumer {
+  void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
+                        const Diagnostic &Info) override {
+    if (DiagLevel < DiagnosticsEngine::Error)
+      return;
+    SmallString<64> Message;
+    Info.FormatDiagnostic(Message);
+    Errors.push_back(
+        Info.getSourceManager().getFilename(Info.getLocation()).str() + ": " +
+        Message.str().str());
+  }
+
+  std::vector<std::string> Errors;
+};
+}
+
+TEST(ClangToolTest, RunInParallel) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  Sources.push_back("/c.cc");
+  Sources.push_back("/d.cc");
+  ClangTool Tool(Compilations, Sources);
+  Tool.mapVirtualFile("/a.cc", "int x = undeclared;");
+  Tool.mapVirtualFile("/b.cc", "void b() {}");
+  Tool.mapVirtualFile("/c.cc", "int y = undeclared_too;");
+  Tool.mapVirtualFile("/d.cc", "void d() {}");
+  RecordingDiagnosticConsumer Consumer;
+  Tool.setDiagnosticConsumer(&Consumer);
+  RecordingActionFactory Action;
+  EXPECT_EQ(1, Tool.runInParallel(&Action, 2));
+
+  // Each file is processed once, in no particular order.
+  std::sort(Action.Files.begin(), Action.Files.end());
+  EXPECT_EQ(Sources, Action.Files);
+  std::sort(Consumer.Errors.begin(), Consumer.Errors.end());
+  ASSERT_EQ(2u, Consumer.Errors.size());
+  EXPECT_EQ("/a.cc: use of undeclared identifier 'undeclared'",
+            Consumer.Errors[0]);
+  EXPECT_EQ("/c.cc: use of undeclared identifier 'undeclared_too'",
+            Consumer.Errors[1]);
+}
+
+#if GTEST_HAS_STREAM_REDIRECTION
+TEST(ClangToolTest, RunInParallelPrintsWithCommandLineOptions) {
+  std::vector<std::string> Args;
+  Args.push_back("-fno-show-column");
+  Args.push_back("-fno-caret-diagnostics");
+  FixedCompilationDatabase Compilations("/", Args);
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  ClangTool Tool(Compilations, Sources);
+  Tool.mapVirtualFile("/a.cc", "int x = undeclared;");
+  Tool.mapVirtualFile("/b.cc", "int y = undeclared_too;");
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+
+  testing::internal::CaptureStderr();
+  int Result = Tool.runInParallel(Action.get(), 2);
+  std::string Errors = testing::internal::GetCapturedStderr();
+  EXPECT_EQ(1, Result);
+
+  // The diagnostics of each file are printed without a column or a caret.
+  EXPECT_NE(std::string::npos,
+            Errors.find("/a.cc:1: error: use of undeclared identifier "
+                        "'undeclared'\n"));
+  EXPECT_NE(std::string::npos,
+            Errors.find("/b.cc:1: error: use of undeclared identifier "
+                        "'undeclared_too'\n"));
+  EXPECT_EQ(std::string::npos, Errors.find('^'));
+}
+#endif
 #endif
 
 } // end namespace tooling
@@ -9,12 +9,16 @@
 
 #include "clang-c/Index.h"
 #include "gtest/gtest.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <set>
+#include <vector>
 #define DEBUG_TYPE "libclang-test"
 
 TEST(libclang, clang_parseTranslationUnit2_InvalidArgs) {
@@ -431,6 +435,202 @@ TEST_F(LibclangReparseTest, Reparse) {
   EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
 }
 
+TEST_F(LibclangReparseTest, ReparseUnchangedFiles) {
+  const char *Header = "struct Foo { int bar; };\n";
+  const char *CppFile = "#include \"HeaderFile.h\"\nint main() {"
+                        " Foo foo; foo.bar = 7; }\n";
+  const char *BrokenCppFile = "#include \"HeaderFile.h\"\nint main() {"
+                              " Foo foo; foo.baz = 7; }\n";
+  std::string HeaderName = "HeaderFile.h";
+  std::string CppName = "CppFile.cpp";
+  WriteFile(CppName, CppFile);
+  WriteFile(HeaderName, Header);
+
+  // The declaration of main in the current AST.
+  auto getMainDecl = [&]() -> const void * {
+    CXFile File = clang_getFile(ClangTU, CppName.c_str());
+    CXCursor C =
+        clang_getCursor(ClangTU, clang_getLocation(ClangTU, File, 2, 5));
+    EXPECT_EQ(CXCursor_FunctionDecl, clang_getCursorKind(C));
+    return C.data[0];
+  };
+
+  ClangTU = clang_parseTranslationUnit(Index, CppName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+  const void *MainDecl = getMainDecl();
+
+  // Nothing changed; the AST is kept.
+  ASSERT_TRUE(ReparseTU(0, nullptr /* No unsaved files. */));
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+  EXPECT_EQ(MainDecl, getMainDecl());
+
+  // An unsaved buffer replaces the main file.
+  CXUnsavedFile Unsaved = { CppName.c_str(), BrokenCppFile,
+                            (unsigned long)strlen(BrokenCppFile) };
+  ASSERT_TRUE(ReparseTU(1, &Unsaved));
+  EXPECT_EQ(1U, clang_getNumDiagnostics(ClangTU));
+
+  // Back to the contents on disk.
+  Unsaved.Contents = CppFile;
+  Unsaved.Length = strlen(CppFile);
+  ASSERT_TRUE(ReparseTU(1, &Unsaved));
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+  MainDecl = getMainDecl();
+  ASSERT_TRUE(ReparseTU(1, &Unsaved));
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+  EXPECT_EQ(MainDecl, getMainDecl());
+
+  // The header changed on disk.
+  WriteFile(HeaderName, "struct Foo { int other; };\n");
+  ASSERT_TRUE(ReparseTU(1, &Unsaved));
+  EXPECT_EQ(1U, clang_getNumDiagnostics(ClangTU));
+}
+
+TEST_F(LibclangReparseTest, ReparseSameSizeEditInSameSecond) {
+  const char *CppFile = "int main() { int bar = 7; return bar; }\n";
+  const char *BrokenCppFile = "int main() { int bar = 7; return baz; }\n";
+  std::string CppName = "CppFile.cpp";
+  WriteFile(CppName, CppFile);
+
+  ClangTU = clang_parseTranslationUnit(Index, CppName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+  llvm::sys::fs::file_status Status;
+  ASSERT_FALSE(llvm::sys::fs::status(CppName, Status));
+
+  // An edit of the same size, saved within the same second as the parse,
+  // changes neither the size nor the modification time of the file.
+  WriteFile(CppName, BrokenCppFile);
+  {
+    int FD;
+    ASSERT_FALSE(llvm::sys::fs::openFileForWrite(CppName, FD,
+                                                 llvm::sys::fs::F_Append));
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    ASSERT_FALSE(llvm::sys::fs::setLastModificationAndAccessTime(
+        FD, Status.getLastModificationTime()));
+  }
+
+  ASSERT_TRUE(ReparseTU(0, nullptr /* No unsaved files. */));
+  EXPECT_EQ(1U, clang_getNumDiagnostics(ClangTU));
+}
+
+#if defined(LLVM_ON_UNIX)
+namespace {
+void collectIncluder(CXFile Included, CXSourceLocation *Stack,
+                     unsigned StackLen, CXClientData ClientData) {
+  if (StackLen == 0)
+    return;
+  CXFile Includer;
+  clang_getSpellingLocation(Stack[0], &Includer, nullptr, nullptr, nullptr);
+  CXString Name = clang_getFileName(Includer);
+  static_cast<std::vector<std::string> *>(ClientData)->push_back(
+      clang_getCString(Name));
+  clang_disposeString(Name);
+}
+}
+
+TEST_F(LibclangReparseTest, SharePreambleBetweenMainFiles) {
+  const char *Header = "struct Foo { int bar; };\n";
+  const char *FirstFile = "#include \"HeaderFile.h\"\n"
+                          "int first() { Foo foo; return foo.bar; }\n";
+  const char *SecondFile = "#include \"HeaderFile.h\"\n"
+                           "int second() { Foo foo; return foo.bar; }\n";
+  std::string HeaderName = "HeaderFile.h";
+  std::string FirstName = "FirstFile.cpp";
+  std::string SecondName = "SecondFile.cpp";
+  WriteFile(HeaderName, Header);
+  WriteFile(FirstName, FirstFile);
+  WriteFile(SecondName, SecondFile);
+  llvm::SmallString<256> PreambleName(TestDir);
+  llvm::sys::path::append(PreambleName, "preamble.pch");
+
+  // Store the first preamble at a known path. A preamble that is not shared
+  // is built into a temporary file instead, as this one is in use.
+  ::setenv("CINDEXTEST_PREAMBLE_FILE", PreambleName.c_str(), 1);
+
+  // The preamble is built on the first reparse.
+  ClangTU = clang_parseTranslationUnit(Index, FirstName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ReparseTU(0, nullptr /* No unsaved files. */));
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+  EXPECT_TRUE(llvm::sys::fs::exists(PreambleName));
+  CXTranslationUnit FirstTU = ClangTU;
+
+  ClangTU = clang_parseTranslationUnit(Index, SecondName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ReparseTU(0, nullptr /* No unsaved files. */));
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+  ::unsetenv("CINDEXTEST_PREAMBLE_FILE");
+
+  // The shared preamble stands for the second main file.
+  std::vector<std::string> Includers;
+  clang_getInclusions(ClangTU, collectIncluder, &Includers);
+  ASSERT_EQ(1U, Includers.size());
+  EXPECT_EQ(SecondName, Includers[0]);
+
+  // The preamble is kept until both translation units are disposed of.
+  clang_disposeTranslationUnit(FirstTU);
+  EXPECT_TRUE(llvm::sys::fs::exists(PreambleName));
+  clang_disposeTranslationUnit(ClangTU);
+  ClangTU = nullptr;
+  EXPECT_FALSE(llvm::sys::fs::exists(PreambleName));
+}
+#endif
+
+namespace {
+struct IndexedUSRs {
+  CXIndexAction Action;
+  std::vector<std::pair<std::string, unsigned> > Decls;
+};
+
+void collectIndexedUSR(CXClientData ClientData, const CXIdxDeclInfo *Info) {
+  IndexedUSRs *USRs = static_cast<IndexedUSRs *>(ClientData);
+  USRs->Decls.push_back(std::make_pair(
+      std::string(Info->entityInfo->USR),
+      clang_index_getEntityUSRID(Info->entityInfo)));
+}
+}
+
+TEST_F(LibclangReparseTest, IndexInternsUSRs) {
+  const char *CppFile = "void f();\nvoid f() {}\nint x;\n";
+  std::string CppName = "CppFile.cpp";
+  WriteFile(CppName, CppFile);
+
+  IndexedUSRs USRs;
+  USRs.Action = clang_IndexAction_create(Index);
+  IndexerCallbacks CB;
+  memset(&CB, 0, sizeof(CB));
+  CB.indexDeclaration = collectIndexedUSR;
+  ASSERT_EQ(0, clang_indexSourceFile(USRs.Action, &USRs, &CB, sizeof(CB), 0,
+                                     CppName.c_str(), nullptr, 0, nullptr, 0,
+                                     &ClangTU, TUFlags));
+  ASSERT_EQ(3U, USRs.Decls.size());
+
+  // Both declarations of f share an ID; x has another one.
+  EXPECT_NE(0U, USRs.Decls[0].second);
+  EXPECT_EQ(USRs.Decls[0].second, USRs.Decls[1].second);
+  EXPECT_NE(USRs.Decls[0].second, USRs.Decls[2].second);
+  for (const auto &Decl : USRs.Decls)
+    EXPECT_STREQ(Decl.first.c_str(),
+                 clang_IndexAction_getUSR(USRs.Action, Decl.second));
+  EXPECT_EQ(nullptr, clang_IndexAction_getUSR(USRs.Action, 0));
+
+  // Cursor USRs are memoized per declaration.
+  CXCursor FCursor = clang_getCursor(
+      ClangTU, clang_getLocation(ClangTU, clang_getFile(ClangTU,
+                                                        CppName.c_str()),
+                                 1, 6));
+  CXString USR1 = clang_getCursorUSR(FCursor);
+  CXString USR2 = clang_getCursorUSR(FCursor);
+  EXPECT_STREQ(USRs.Decls[0].first.c_str(), clang_getCString(USR1));
+  EXPECT_EQ(clang_getCString(USR1), clang_getCString(USR2));
+  clang_disposeString(USR1);
+  clang_disposeString(USR2);
+
+  clang_IndexAction_dispose(USRs.Action);
+}
+
 TEST_F(LibclangReparseTest, ReparseWithModule) {
   const char *HeaderTop = "#ifndef H\n#define H\nstruct Foo { int bar;";
   const char *HeaderBottom = "\n};\n#endif\n";